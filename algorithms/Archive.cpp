@@ -0,0 +1,496 @@
+#include "Archive.h"
+#include "Kernels.h"
+#include "Parallel.h"
+#include <filesystem>
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+#include <unordered_set>
+
+static const char ARCHIVE_MAGIC[4] = {'M', 'L', 'C', 'A'};
+static const char TRAILER_MAGIC[4] = {'M', 'L', 'C', 'D'};
+static const unsigned char ARCHIVE_VERSION = 1;
+static const size_t HEADER_SIZE = 5;
+static const size_t TRAILER_SIZE = 20;
+static const size_t ARCHIVE_READ_SIZE = 64 * 1024;
+
+static void putU8(string &out, uint8_t v)
+{
+    out += (char)v;
+}
+
+static void putU16(string &out, uint16_t v)
+{
+    for (int b = 0; b < 2; ++b)
+        out += (char)((v >> (8 * b)) & 0xff);
+}
+
+static void putU32(string &out, uint32_t v)
+{
+    for (int b = 0; b < 4; ++b)
+        out += (char)((v >> (8 * b)) & 0xff);
+}
+
+static void putU64(string &out, uint64_t v)
+{
+    for (int b = 0; b < 8; ++b)
+        out += (char)((v >> (8 * b)) & 0xff);
+}
+
+// Bounds-checked reader over the serialized directory.
+class DirectoryCursor
+{
+private:
+    const string &data;
+    size_t pos;
+
+    uint64_t get(int bytes)
+    {
+        if (data.size() - pos < (size_t)bytes)
+            throw runtime_error("Corrupt archive directory.");
+        uint64_t v = 0;
+        for (int b = 0; b < bytes; ++b)
+            v |= (uint64_t)(unsigned char)data[pos++] << (8 * b);
+        return v;
+    }
+
+public:
+    explicit DirectoryCursor(const string &data) : data(data), pos(0) {}
+
+    uint8_t u8() { return (uint8_t)get(1); }
+    uint16_t u16() { return (uint16_t)get(2); }
+    uint32_t u32() { return (uint32_t)get(4); }
+    uint64_t u64() { return get(8); }
+
+    string bytes(size_t n)
+    {
+        if (data.size() - pos < n)
+            throw runtime_error("Corrupt archive directory.");
+        string s = data.substr(pos, n);
+        pos += n;
+        return s;
+    }
+
+    bool atEnd() const { return pos == data.size(); }
+};
+
+// Stored name for a path given on the command line: generic separators, no
+// root, no leading "..", no "." components.
+static string archiveName(const filesystem::path &path)
+{
+    filesystem::path name;
+    bool leading = true;
+    for (const auto &part : path.lexically_normal().relative_path())
+    {
+        if (leading && part == "..")
+            continue;
+        leading = false;
+        if (part != "." && !part.empty())
+            name /= part;
+    }
+    return name.generic_string();
+}
+
+vector<ArchiveInput> collectArchiveInputs(const vector<string> &paths)
+{
+    vector<ArchiveInput> inputs;
+    for (const string &p : paths)
+    {
+        filesystem::path path(p);
+        if (filesystem::is_directory(path))
+        {
+            vector<filesystem::path> files;
+            for (const auto &entry : filesystem::recursive_directory_iterator(path))
+                if (entry.is_regular_file())
+                    files.push_back(entry.path());
+            sort(files.begin(), files.end());
+            for (const auto &file : files)
+                inputs.push_back({archiveName(file), file.string()});
+        }
+        else if (filesystem::is_regular_file(path))
+        {
+            inputs.push_back({archiveName(path), path.string()});
+        }
+        else
+        {
+            throw runtime_error("No such file or directory: " + p);
+        }
+    }
+    return inputs;
+}
+
+ArchiveStats createArchive(const string &archivePath, const vector<ArchiveInput> &files, const Compressor &compressor,
+                           size_t blockSize, unsigned threads)
+{
+    if (blockSize == 0)
+        blockSize = DEFAULT_BLOCK_SIZE;
+    if (threads == 0)
+        threads = defaultThreadCount();
+
+    // Names must be unique: collectArchiveInputs() strips leading "../", so
+    // "a/x" and "../a/x" would otherwise both be stored as "a/x".
+    unordered_set<string> names;
+    for (const ArchiveInput &file : files)
+    {
+        if (file.name.empty() || file.name.size() > UINT16_MAX)
+            throw runtime_error("Invalid archive name for " + file.source + ".");
+        if (!names.insert(file.name).second)
+            throw runtime_error("Duplicate archive name: " + file.name);
+    }
+
+    ofstream out(archivePath, ios::binary);
+    if (!out)
+        throw runtime_error("Could not create archive " + archivePath + ".");
+    out.write(ARCHIVE_MAGIC, 4);
+    out.put((char)ARCHIVE_VERSION);
+
+    ArchiveStats stats;
+    string blockRecords;
+    uint64_t fileOffset = HEADER_SIZE;
+    vector<string> pending;
+    string current;
+
+    // Compresses the queued blocks as one parallel batch and appends them.
+    auto writePending = [&]()
+    {
+        vector<CompressedBlock> compressed = compressor.compressBatch(pending, threads);
+        for (size_t i = 0; i < compressed.size(); ++i)
+        {
+            const CompressedBlock &block = compressed[i];
+            string packed((block.data.size() + 7) / 8, '\0');
+            if (!packed.empty() &&
+                !kernels().packBits(block.data.data(), block.data.size(), reinterpret_cast<unsigned char *>(&packed[0])))
+                throw runtime_error("Compressor produced an invalid bit string.");
+            out.write(packed.data(), packed.size());
+
+            putU64(blockRecords, fileOffset);
+            putU64(blockRecords, packed.size());
+            putU64(blockRecords, block.data.size());
+            putU64(blockRecords, pending[i].size());
+            putU64(blockRecords, block.primaryIndex);
+            putU8(blockRecords, (uint8_t)block.backend);
+            putU32(blockRecords, block.checksum);
+            putU8(blockRecords, (uint8_t)block.modelId.size());
+            blockRecords += block.modelId;
+            putU16(blockRecords, (uint16_t)block.freqTable.size());
+            for (const auto &entry : block.freqTable)
+            {
+                putU8(blockRecords, entry.first);
+                putU64(blockRecords, entry.second);
+            }
+            fileOffset += packed.size();
+            stats.blocks++;
+        }
+        pending.clear();
+    };
+
+    string entryRecords;
+    uint64_t streamOffset = 0;
+    vector<char> buffer(ARCHIVE_READ_SIZE);
+    for (const ArchiveInput &file : files)
+    {
+        ifstream in(file.source, ios::binary);
+        if (!in)
+            throw runtime_error("Could not read " + file.source + ".");
+
+        // Append the file to the current block; a file larger than what is
+        // left spills into as many following blocks as it needs.
+        uint64_t size = 0;
+        while (in.read(buffer.data(), buffer.size()) || in.gcount() > 0)
+        {
+            size_t got = (size_t)in.gcount();
+            size += got;
+            for (const char *data = buffer.data(); got > 0;)
+            {
+                if (current.empty())
+                    current.reserve(blockSize);
+                size_t n = min(got, blockSize - current.size());
+                current.append(data, n);
+                data += n;
+                got -= n;
+                if (current.size() == blockSize)
+                {
+                    pending.emplace_back();
+                    pending.back().swap(current);
+                    if (pending.size() >= 2 * (size_t)threads)
+                        writePending();
+                }
+            }
+        }
+        if (in.bad())
+            throw runtime_error("Could not read " + file.source + ".");
+
+        putU16(entryRecords, (uint16_t)file.name.size());
+        entryRecords += file.name;
+        putU64(entryRecords, size);
+        putU64(entryRecords, streamOffset);
+        streamOffset += size;
+        stats.files++;
+    }
+    if (!current.empty())
+        pending.push_back(move(current));
+    writePending();
+
+    string directory;
+    putU64(directory, blockSize);
+    putU64(directory, stats.blocks);
+    directory += blockRecords;
+    putU64(directory, stats.files);
+    directory += entryRecords;
+
+    string trailer;
+    putU64(trailer, fileOffset);
+    putU64(trailer, directory.size());
+    trailer.append(TRAILER_MAGIC, 4);
+    out.write(directory.data(), directory.size());
+    out.write(trailer.data(), trailer.size());
+    out.close();
+    if (!out)
+        throw runtime_error("Could not write archive " + archivePath + ".");
+
+    stats.inputBytes = streamOffset;
+    stats.archiveBytes = fileOffset + directory.size() + trailer.size();
+    return stats;
+}
+
+ArchiveReader::ArchiveReader(const string &archivePath) : in(archivePath, ios::binary), blockSize(0)
+{
+    if (!in)
+        throw runtime_error("Could not open archive " + archivePath + ".");
+
+    in.seekg(0, ios::end);
+    uint64_t fileSize = (uint64_t)in.tellg();
+    char header[HEADER_SIZE];
+    char trailerBytes[TRAILER_SIZE];
+    in.seekg(0);
+    in.read(header, HEADER_SIZE);
+    if (fileSize < HEADER_SIZE + TRAILER_SIZE || !in || !equal(header, header + 4, ARCHIVE_MAGIC))
+        throw runtime_error(archivePath + " is not an archive.");
+    if ((unsigned char)header[4] != ARCHIVE_VERSION)
+        throw runtime_error("Unsupported archive version.");
+
+    in.seekg(fileSize - TRAILER_SIZE);
+    in.read(trailerBytes, TRAILER_SIZE);
+    string trailer(trailerBytes, TRAILER_SIZE);
+    DirectoryCursor tail(trailer);
+    uint64_t directoryOffset = tail.u64();
+    uint64_t directoryLength = tail.u64();
+    if (!in || tail.bytes(4) != string(TRAILER_MAGIC, 4) || directoryOffset < HEADER_SIZE ||
+        directoryOffset > fileSize || directoryLength != fileSize - TRAILER_SIZE - directoryOffset)
+        throw runtime_error("Corrupt archive trailer.");
+
+    string directory(directoryLength, '\0');
+    in.seekg(directoryOffset);
+    in.read(&directory[0], directoryLength);
+    if (!in)
+        throw runtime_error("Corrupt archive directory.");
+
+    DirectoryCursor cursor(directory);
+    blockSize = cursor.u64();
+    uint64_t count = cursor.u64();
+    if (blockSize == 0 || count > directoryLength)
+        throw runtime_error("Corrupt archive directory.");
+    uint64_t streamSize = 0;
+    for (uint64_t i = 0; i < count; ++i)
+    {
+        BlockRecord record;
+        record.fileOffset = cursor.u64();
+        record.byteLength = cursor.u64();
+        record.bitCount = cursor.u64();
+        record.rawSize = cursor.u64();
+        record.block.primaryIndex = cursor.u64();
+        uint8_t coder = cursor.u8();
+        if (coder > (uint8_t)EntropyBackend::RANS)
+            throw runtime_error("Corrupt archive directory.");
+        record.block.backend = (EntropyBackend)coder;
+        record.block.hasChecksum = true;
+        record.block.checksum = cursor.u32();
+        record.block.modelId = cursor.bytes(cursor.u8());
+        for (uint16_t n = cursor.u16(); n > 0; --n)
+        {
+            unsigned char symbol = cursor.u8();
+            record.block.freqTable[symbol] = cursor.u64();
+        }
+        // Every block but the last is full, so block i starts at
+        // i * blockSize in the stream.
+        bool last = i + 1 == count;
+        if (record.fileOffset < HEADER_SIZE || record.byteLength > directoryOffset - record.fileOffset ||
+            record.fileOffset > directoryOffset || record.bitCount > record.byteLength * 8 ||
+            record.rawSize > blockSize || (!last && record.rawSize != blockSize))
+            throw runtime_error("Corrupt archive directory.");
+        streamSize += record.rawSize;
+        blocks.push_back(move(record));
+    }
+
+    uint64_t entries = cursor.u64();
+    if (entries > directoryLength)
+        throw runtime_error("Corrupt archive directory.");
+    for (uint64_t i = 0; i < entries; ++i)
+    {
+        ArchiveEntry entry;
+        entry.path = cursor.bytes(cursor.u16());
+        entry.size = cursor.u64();
+        entry.offset = cursor.u64();
+        if (entry.offset > streamSize || entry.size > streamSize - entry.offset ||
+            (!entryList.empty() && entry.offset < entryList.back().offset + entryList.back().size))
+            throw runtime_error("Corrupt archive directory.");
+        entryList.push_back(move(entry));
+    }
+    if (!cursor.atEnd())
+        throw runtime_error("Corrupt archive directory.");
+}
+
+CompressedBlock ArchiveReader::loadBlock(size_t index)
+{
+    const BlockRecord &record = blocks[index];
+    string packed(record.byteLength, '\0');
+    in.seekg(record.fileOffset);
+    in.read(&packed[0], packed.size());
+    if (!in)
+        throw runtime_error("Could not read archive block.");
+
+    CompressedBlock block = record.block;
+    block.data.assign(packed.size() * 8, '0');
+    kernels().unpackBits(reinterpret_cast<const unsigned char *>(packed.data()), packed.size(), &block.data[0]);
+    block.data.resize(record.bitCount);
+    return block;
+}
+
+void ArchiveReader::decodeBlocks(const vector<size_t> &indices, const Compressor &compressor, unsigned threads,
+                                 const function<void(size_t, const string &)> &sink)
+{
+    if (threads == 0)
+        threads = defaultThreadCount();
+
+    // Only a window of compressed blocks is loaded at a time.
+    size_t window = 2 * (size_t)threads;
+    for (size_t first = 0; first < indices.size(); first += window)
+    {
+        size_t last = min(indices.size(), first + window);
+        vector<CompressedBlock> chunk;
+        for (size_t k = first; k < last; ++k)
+            chunk.push_back(loadBlock(indices[k]));
+
+        size_t k = first;
+        compressor.decompressBlocks(chunk, [&](const string &data)
+                                    {
+                                        if (data.size() != blocks[indices[k]].rawSize)
+                                            throw runtime_error("Archive block has the wrong size.");
+                                        sink(indices[k++], data);
+                                    },
+                                    threads);
+    }
+}
+
+vector<size_t> ArchiveReader::blocksFor(const ArchiveEntry &entry) const
+{
+    vector<size_t> indices;
+    if (entry.size == 0)
+        return indices;
+    for (uint64_t b = entry.offset / blockSize; b <= (entry.offset + entry.size - 1) / blockSize; ++b)
+        indices.push_back((size_t)b);
+    return indices;
+}
+
+long ArchiveReader::find(const string &path) const
+{
+    for (size_t i = 0; i < entryList.size(); ++i)
+        if (entryList[i].path == path)
+            return (long)i;
+    return -1;
+}
+
+string ArchiveReader::read(size_t index, const Compressor &compressor, unsigned threads)
+{
+    const ArchiveEntry &entry = entryList.at(index);
+    string output;
+    output.reserve(entry.size);
+    decodeBlocks(blocksFor(entry), compressor, threads, [&](size_t block, const string &data)
+                 {
+                     uint64_t blockStart = block * blockSize;
+                     uint64_t start = max(entry.offset, blockStart);
+                     uint64_t end = min(entry.offset + entry.size, blockStart + data.size());
+                     output.append(data, start - blockStart, end - start);
+                 });
+    return output;
+}
+
+// Destination for an entry under outputDir, refusing names that would
+// escape it.
+static filesystem::path outputPath(const string &outputDir, const string &name)
+{
+    filesystem::path relative(name);
+    if (name.empty() || relative.is_absolute() || relative.has_root_name() || relative.has_root_directory())
+        throw runtime_error("Unsafe path in archive: " + name);
+    for (const auto &part : relative)
+        if (part == "..")
+            throw runtime_error("Unsafe path in archive: " + name);
+    return filesystem::path(outputDir) / relative;
+}
+
+static void openOutput(ofstream &out, const filesystem::path &path)
+{
+    if (path.has_parent_path())
+        filesystem::create_directories(path.parent_path());
+    out.open(path, ios::binary | ios::trunc);
+    if (!out)
+        throw runtime_error("Could not write " + path.string() + ".");
+}
+
+void ArchiveReader::extract(const string &outputDir, const Compressor &compressor, vector<size_t> selected,
+                            unsigned threads)
+{
+    if (selected.empty())
+        for (size_t i = 0; i < entryList.size(); ++i)
+            selected.push_back(i);
+    sort(selected.begin(), selected.end());
+    selected.erase(unique(selected.begin(), selected.end()), selected.end());
+
+    // Validate every name before writing anything.
+    vector<filesystem::path> paths;
+    for (size_t index : selected)
+        paths.push_back(outputPath(outputDir, entryList.at(index).path));
+
+    // Empty files need no blocks.
+    vector<size_t> pendingEntries;
+    vector<size_t> needed;
+    for (size_t i = 0; i < selected.size(); ++i)
+    {
+        size_t index = selected[i];
+        const ArchiveEntry &entry = entryList[index];
+        if (entry.size == 0)
+        {
+            ofstream empty;
+            openOutput(empty, paths[i]);
+            continue;
+        }
+        pendingEntries.push_back(index);
+        for (size_t block : blocksFor(entry))
+            if (needed.empty() || needed.back() < block)
+                needed.push_back(block);
+    }
+
+    // Entries are disjoint and in stream order, so at most one file is
+    // open across a block boundary.
+    size_t next = 0;
+    ofstream out;
+    decodeBlocks(needed, compressor, threads, [&](size_t block, const string &data)
+                 {
+                     uint64_t blockStart = block * blockSize, blockEnd = blockStart + data.size();
+                     while (next < pendingEntries.size() && entryList[pendingEntries[next]].offset < blockEnd)
+                     {
+                         const ArchiveEntry &entry = entryList[pendingEntries[next]];
+                         uint64_t start = max(entry.offset, blockStart);
+                         uint64_t end = min(entry.offset + entry.size, blockEnd);
+                         if (!out.is_open())
+                             openOutput(out, outputPath(outputDir, entry.path));
+                         out.write(data.data() + (start - blockStart), end - start);
+                         if (entry.offset + entry.size > blockEnd)
+                             break;
+                         out.close();
+                         if (!out)
+                             throw runtime_error("Could not write " + entry.path + ".");
+                         next++;
+                     }
+                 });
+}
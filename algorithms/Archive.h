@@ -0,0 +1,108 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <fstream>
+#include <cstdint>
+#include <functional>
+#include "Compressor.h"
+
+using namespace std;
+
+// Multi-file archive (.mlca). All files are concatenated, in order, into
+// one logical stream that is cut into blockSize blocks and compressed in
+// parallel, so small files share blocks and large ones span several. A
+// central directory at the end records every block and every file's
+// offset in the stream, so listing reads only the directory and
+// extracting a file decodes only the blocks it overlaps.
+//
+// Layout, integers little-endian:
+//   "MLCA" u8 version
+//   packed block payloads, back to back
+//   directory: u64 blockSize, u64 blockCount, blockCount block records,
+//              u64 entryCount, entryCount entry records
+//   trailer:   u64 directoryOffset, u64 directoryLength, "MLCD"
+// Block record: u64 fileOffset, u64 byteLength, u64 bitCount, u64 rawSize,
+//   u64 primaryIndex, u8 coder, u32 crc, u8 modelIdLength + id,
+//   u16 tableSize + tableSize * (u8 symbol, u64 count)
+// Entry record: u16 pathLength + path, u64 size, u64 offset
+
+// A file to add: its name inside the archive and where to read it from.
+struct ArchiveInput
+{
+    string name;
+    string source;
+};
+
+struct ArchiveEntry
+{
+    string path;
+    uint64_t size = 0;
+    // Position of the file's first byte in the concatenated stream.
+    uint64_t offset = 0;
+};
+
+// Totals reported by createArchive().
+struct ArchiveStats
+{
+    size_t files = 0;
+    size_t blocks = 0;
+    uint64_t inputBytes = 0;
+    uint64_t archiveBytes = 0;
+};
+
+// Collects the regular files under each path (directories recursively, in
+// sorted order) as archive inputs. Names keep the path as given, with '/'
+// separators and any root or leading "../" stripped.
+vector<ArchiveInput> collectArchiveInputs(const vector<string> &paths);
+
+// Writes an archive of files to archivePath. At most 2 * threads blocks
+// are held in memory at a time. Throws runtime_error on I/O failure or if
+// two files share a name.
+ArchiveStats createArchive(const string &archivePath, const vector<ArchiveInput> &files, const Compressor &compressor,
+                           size_t blockSize = DEFAULT_BLOCK_SIZE, unsigned threads = 0);
+
+class ArchiveReader
+{
+private:
+    struct BlockRecord
+    {
+        uint64_t fileOffset = 0;
+        uint64_t byteLength = 0;
+        uint64_t bitCount = 0;
+        uint64_t rawSize = 0;
+        CompressedBlock block; // everything but the payload
+    };
+
+    ifstream in;
+    uint64_t blockSize;
+    vector<BlockRecord> blocks;
+    vector<ArchiveEntry> entryList;
+
+    CompressedBlock loadBlock(size_t index);
+    vector<size_t> blocksFor(const ArchiveEntry &entry) const;
+
+    // Decodes the listed blocks in parallel, a window at a time, calling
+    // sink(blockIndex, data) in list order.
+    void decodeBlocks(const vector<size_t> &indices, const Compressor &compressor, unsigned threads,
+                      const function<void(size_t, const string &)> &sink);
+
+public:
+    // Reads the trailer and central directory; throws runtime_error if the
+    // file is not a valid archive.
+    explicit ArchiveReader(const string &archivePath);
+
+    const vector<ArchiveEntry> &entries() const { return entryList; }
+    size_t blockCount() const { return blocks.size(); }
+
+    // Index of the entry stored under path, or -1 if there is none.
+    long find(const string &path) const;
+
+    // Returns one entry's contents, decoding only the blocks it overlaps.
+    string read(size_t entry, const Compressor &compressor, unsigned threads = 0);
+
+    // Writes the given entries (all of them if empty) under outputDir,
+    // decoding each needed block once, in parallel. Entry paths that are
+    // absolute or contain ".." are rejected.
+    void extract(const string &outputDir, const Compressor &compressor, vector<size_t> selected = {},
+                 unsigned threads = 0);
+};
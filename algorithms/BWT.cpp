@@ -1,34 +1,40 @@
 #include "BWT.h"
 #include <vector>
 #include <algorithm>
+#include <cstdint>
+#include <stdexcept>
 
 using namespace std;
 
-string bwtEncode(const string &input, int &primaryIndex)
+// Suffix array and LF entries use 32-bit indices whenever the block fits,
+// halving their footprint and cache traffic; larger blocks fall back to
+// 64-bit indices.
+template <typename Index>
+static string bwtEncodeWith(const string &input, size_t &primaryIndex)
 {
-    int n = input.size();
-    vector<int> suffixArray(n);
-    for (int i = 0; i < n; i++)
-        suffixArray[i] = i;
+    size_t n = input.size();
+    vector<Index> suffixArray(n);
+    for (size_t i = 0; i < n; i++)
+        suffixArray[i] = (Index)i;
 
     // Efficient cyclic comparator
-    sort(suffixArray.begin(), suffixArray.end(), [&](int a, int b)
+    sort(suffixArray.begin(), suffixArray.end(), [&](Index a, Index b)
          {
-             for (int i = 0; i < n; ++i)
+             for (size_t i = 0; i < n; ++i)
              {
                  unsigned char ca = input[(a + i) % n];
                  unsigned char cb = input[(b + i) % n];
                  if (ca != cb)
                      return ca < cb;
              }
-             return false; 
+             return false;
          });
 
     string bwt;
     bwt.reserve(n);
-    for (int i = 0; i < n; i++)
+    for (size_t i = 0; i < n; i++)
     {
-        int index = suffixArray[i];
+        size_t index = suffixArray[i];
         bwt += (index == 0) ? input[n - 1] : input[index - 1];
         if (index == 0)
             primaryIndex = i;
@@ -36,14 +42,46 @@ string bwtEncode(const string &input, int &primaryIndex)
     return bwt;
 }
 
-string bwtDecode(const string &bwtString, int primaryIndex)
+string bwtEncode(const string &input, size_t &primaryIndex)
 {
-    if (bwtString.empty())
-        return "";
+    if (input.size() <= UINT32_MAX)
+        return bwtEncodeWith<uint32_t>(input, primaryIndex);
+    return bwtEncodeWith<uint64_t>(input, primaryIndex);
+}
+
+string bwtEncodeApprox(const string &input, size_t depth)
+{
+    size_t n = input.size();
+    if (depth > n)
+        depth = n;
+    vector<size_t> rotations(n);
+    for (size_t i = 0; i < n; i++)
+        rotations[i] = i;
 
-    int n = bwtString.size();
-    vector<int> count(256, 0);
-    vector<int> tots(256, 0);
+    stable_sort(rotations.begin(), rotations.end(), [&](size_t a, size_t b)
+                {
+                    for (size_t i = 0; i < depth; ++i)
+                    {
+                        unsigned char ca = input[(a + i) % n];
+                        unsigned char cb = input[(b + i) % n];
+                        if (ca != cb)
+                            return ca < cb;
+                    }
+                    return false;
+                });
+
+    string bwt(n, '\0');
+    for (size_t i = 0; i < n; i++)
+        bwt[i] = input[(rotations[i] + n - 1) % n];
+    return bwt;
+}
+
+template <typename Index>
+static string bwtDecodeWith(const string &bwtString, size_t primaryIndex)
+{
+    size_t n = bwtString.size();
+    vector<Index> count(256, 0);
+    vector<Index> tots(256, 0);
 
     // Count character occurrences
     for (char ch : bwtString)
@@ -54,9 +92,9 @@ string bwtDecode(const string &bwtString, int primaryIndex)
         tots[i] = tots[i - 1] + count[i - 1];
 
     // Build LF-mapping
-    vector<int> lf(n);
-    vector<int> occ(256, 0);
-    for (int i = 0; i < n; i++)
+    vector<Index> lf(n);
+    vector<Index> occ(256, 0);
+    for (size_t i = 0; i < n; i++)
     {
         lf[i] = tots[(unsigned char)bwtString[i]] + occ[(unsigned char)bwtString[i]];
         occ[(unsigned char)bwtString[i]]++;
@@ -64,11 +102,91 @@ string bwtDecode(const string &bwtString, int primaryIndex)
 
     // Reconstruct original string
     string result(n, ' ');
-    int index = primaryIndex;
-    for (int i = n - 1; i >= 0; i--)
+    size_t index = primaryIndex;
+    for (size_t i = n; i-- > 0;)
     {
         result[i] = bwtString[index];
         index = lf[index];
     }
     return result;
 }
+
+string bwtDecode(const string &bwtString, size_t primaryIndex)
+{
+    if (bwtString.empty())
+        return "";
+    if (primaryIndex >= bwtString.size())
+        throw runtime_error("Invalid BWT data: primary index out of range.");
+
+    if (bwtString.size() <= UINT32_MAX)
+        return bwtDecodeWith<uint32_t>(bwtString, primaryIndex);
+    return bwtDecodeWith<uint64_t>(bwtString, primaryIndex);
+}
+
+// Rows between occurrence checkpoints in bwtDecodeLowMemory().
+static const size_t LOW_MEMORY_INTERVAL = 4096;
+
+// Instead of an LF table, keeps the BWT string plus the count of every
+// symbol before each LOW_MEMORY_INTERVAL-th row, and computes LF by counting
+// from the nearest checkpoint.
+template <typename Index>
+static string bwtDecodeSampled(const string &bwtString, size_t primaryIndex)
+{
+    size_t n = bwtString.size();
+    size_t checkpoints = n / LOW_MEMORY_INTERVAL + 1;
+    const unsigned char *text = reinterpret_cast<const unsigned char *>(bwtString.data());
+
+    // occ[k * 256 + c] is the number of c in text[0, k * LOW_MEMORY_INTERVAL),
+    // with a final entry for the whole string.
+    vector<Index> occ((checkpoints + 1) * 256, 0);
+    for (size_t k = 0; k < checkpoints; ++k)
+    {
+        Index *next = &occ[(k + 1) * 256];
+        copy(next - 256, next, next);
+        size_t end = min(n, (k + 1) * LOW_MEMORY_INTERVAL);
+        for (size_t i = k * LOW_MEMORY_INTERVAL; i < end; ++i)
+            next[text[i]]++;
+    }
+
+    // tots[c] is the first row of the sorted rotations starting with c.
+    const Index *total = &occ[checkpoints * 256];
+    size_t tots[256];
+    size_t sum = 0;
+    for (int c = 0; c < 256; ++c)
+    {
+        tots[c] = sum;
+        sum += total[c];
+    }
+
+    string result(n, ' ');
+    size_t row = primaryIndex;
+    for (size_t i = n; i-- > 0;)
+    {
+        unsigned char c = text[row];
+        result[i] = (char)c;
+
+        // Occurrences of c before row, counted from whichever checkpoint is
+        // closer; the final window may be short.
+        size_t k = row / LOW_MEMORY_INTERVAL;
+        size_t base = k * LOW_MEMORY_INTERVAL;
+        size_t rank;
+        if (row - base <= LOW_MEMORY_INTERVAL / 2 || k + 1 >= checkpoints)
+            rank = occ[k * 256 + c] + count(text + base, text + row, c);
+        else
+            rank = occ[(k + 1) * 256 + c] - count(text + row, text + min(n, base + LOW_MEMORY_INTERVAL), c);
+        row = tots[c] + rank;
+    }
+    return result;
+}
+
+string bwtDecodeLowMemory(const string &bwtString, size_t primaryIndex)
+{
+    if (bwtString.empty())
+        return "";
+    if (primaryIndex >= bwtString.size())
+        throw runtime_error("Invalid BWT data: primary index out of range.");
+
+    if (bwtString.size() <= UINT32_MAX)
+        return bwtDecodeSampled<uint32_t>(bwtString, primaryIndex);
+    return bwtDecodeSampled<uint64_t>(bwtString, primaryIndex);
+}
@@ -3,5 +3,17 @@
 #include<string>
 using namespace std;
 
-string bwtEncode(const string &input , int &primaryIndex);
-string bwtDecode(const string &bwtString , int primaryIndex);
\ No newline at end of file
+string bwtEncode(const string &input , size_t &primaryIndex);
+string bwtDecode(const string &bwtString , size_t primaryIndex);
+
+// Inverse BWT for memory-constrained decoders. Instead of an LF table of
+// 32/64-bit entries it keeps 32-bit occurrence counts for all 256 symbols
+// every 4096 rows and counts the rest of each LF step from the BWT string:
+// peak use is about 2.25n bytes with the output rather than 6n. Slower
+// than bwtDecode().
+string bwtDecodeLowMemory(const string &bwtString, size_t primaryIndex);
+
+// Approximate forward BWT for size estimation: rotations are ordered by
+// their first `depth` bytes only, ties keeping text order, so the sort costs
+// O(n log n * depth) however repetitive the input. Not invertible.
+string bwtEncodeApprox(const string &input, size_t depth);
@@ -0,0 +1,186 @@
+#include "BlockJson.h"
+#include "Model.h"
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <algorithm>
+using namespace std;
+
+string escape_json(const string& s) {
+    ostringstream out;
+    for (unsigned char c : s) {
+        switch (c) {
+            case '"': out << "\\\""; break;
+            case '\\': out << "\\\\"; break;
+            case '\b': out << "\\b"; break;
+            case '\f': out << "\\f"; break;
+            case '\n': out << "\\n"; break;
+            case '\r': out << "\\r"; break;
+            case '\t': out << "\\t"; break;
+            default:
+                if (c < 0x20 || c > 0x7E) {
+                    out << "\\u" << hex << setw(4) << setfill('0') << (int)c;
+                } else {
+                    out << c;
+                }
+        }
+    }
+    return out.str();
+}
+
+void writeBlockJson(ostream& out, const CompressedBlock& block) {
+    out << "{\"compressed\":\"" << escape_json(block.data) << "\",\"primaryIndex\":" << block.primaryIndex
+        << ",\"coder\":\"" << entropyBackendName(block.backend) << "\"";
+    if (block.hasChecksum) out << ",\"crc\":" << block.checksum;
+    if (!block.modelId.empty()) {
+        // The shared model replaces the per-payload frequency table.
+        out << ",\"model\":\"" << block.modelId << "\"}";
+        return;
+    }
+    out << ",\"freqTable\":{";
+    bool first = true;
+    for (auto& kv : block.freqTable) {
+        if (!first) out << ",";
+        out << "\"" << (int)(unsigned char)kv.first << "\":" << kv.second;
+        first = false;
+    }
+    out << "}}";
+}
+
+// Field extraction for parseBlock(); the numeric conversions may throw.
+static bool parseBlockFields(const string& input, CompressedBlock& block) {
+    size_t compressedStart = input.find("\"compressed\":\"");
+    if (compressedStart == string::npos) {
+        cerr << "[ERROR] Could not find compressed data in input!" << endl;
+        return false;
+    }
+    compressedStart += 14;
+    size_t compressedEnd = input.find("\"", compressedStart);
+    if (compressedEnd == string::npos) {
+        cerr << "[ERROR] Could not find end of compressed data!" << endl;
+        return false;
+    }
+    block.data = input.substr(compressedStart, compressedEnd - compressedStart);
+
+    size_t indexStart = input.find("\"primaryIndex\":");
+    if (indexStart == string::npos) {
+        cerr << "[ERROR] Could not find primaryIndex in input!" << endl;
+        return false;
+    }
+    indexStart += 15;
+    size_t indexEnd = input.find(",", indexStart);
+    if (indexEnd == string::npos) indexEnd = input.find("}", indexStart);
+    block.primaryIndex = stoull(input.substr(indexStart, indexEnd - indexStart));
+
+    // Older payloads carry no coder field and are always Huffman.
+    size_t coderStart = input.find("\"coder\":\"");
+    if (coderStart != string::npos) {
+        coderStart += 9;
+        size_t coderEnd = input.find("\"", coderStart);
+        if (coderEnd == string::npos || !parseEntropyBackend(input.substr(coderStart, coderEnd - coderStart), block.backend)) {
+            cerr << "[ERROR] Unknown entropy coder in input!" << endl;
+            return false;
+        }
+    }
+
+    // Checksums are optional so older payloads still decode.
+    size_t crcStart = input.find("\"crc\":");
+    if (crcStart != string::npos) {
+        block.hasChecksum = true;
+        block.checksum = (uint32_t)stoul(input.substr(crcStart + 6));
+    }
+
+    // Payloads compressed against a shared model reference it by id
+    // instead of carrying a frequency table.
+    size_t modelStart = input.find("\"model\":\"");
+    if (modelStart != string::npos) {
+        modelStart += 9;
+        size_t modelEnd = input.find("\"", modelStart);
+        block.modelId = modelEnd == string::npos ? "" : input.substr(modelStart, modelEnd - modelStart);
+        if (!isValidModelId(block.modelId)) {
+            cerr << "[ERROR] Invalid model id in input!" << endl;
+            return false;
+        }
+        return true;
+    }
+
+    size_t freqStart = input.find("\"freqTable\":{");
+    if (freqStart == string::npos) {
+        cerr << "[ERROR] Could not find freqTable in input!" << endl;
+        return false;
+    }
+    freqStart += 12;
+    size_t freqEnd = input.find("}", freqStart);
+    if (freqEnd == string::npos) {
+        cerr << "[ERROR] Could not find end of freqTable!" << endl;
+        return false;
+    }
+    string freqStr = input.substr(freqStart, freqEnd - freqStart);
+
+    stringstream ss(freqStr);
+    string pair;
+    while (getline(ss, pair, ',')) {
+        size_t colon = pair.find(':');
+        if (colon != string::npos) {
+            size_t quote = pair.find('"');
+            if (quote == string::npos || quote+1 >= pair.size()) continue;
+            int key = stoi(pair.substr(quote+1, colon-quote-1));
+            uint64_t value = stoull(pair.substr(colon+1));
+            block.freqTable[static_cast<unsigned char>(key)] = value;
+        }
+    }
+    return true;
+}
+
+bool parseBlock(const string& input, CompressedBlock& block) {
+    try {
+        return parseBlockFields(input, block);
+    } catch (exception&) {
+        cerr << "[ERROR] Malformed number in input!" << endl;
+        return false;
+    }
+}
+
+bool splitBlocks(const string& input, vector<string>& objects) {
+    size_t pos = input.find("\"blocks\":[");
+    if (pos == string::npos) return false;
+    pos += 10;
+    int depth = 0;
+    size_t start = 0;
+    for (; pos < input.size(); ++pos) {
+        char c = input[pos];
+        if (c == '{') {
+            if (depth++ == 0) start = pos;
+        } else if (c == '}') {
+            if (--depth == 0) objects.push_back(input.substr(start, pos - start + 1));
+        } else if (c == ']' && depth == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool readBatch(istream& in, vector<string>& inputs) {
+    string header;
+    while (getline(in, header)) {
+        if (header.empty()) continue;
+        if (header.find_first_not_of("0123456789") != string::npos) return false;
+        size_t length;
+        try {
+            length = stoull(header);
+        } catch (exception&) {
+            return false;
+        }
+        // Grow the frame as bytes arrive so a bogus length cannot force a
+        // huge allocation up front.
+        const size_t chunk = 1 << 20;
+        string frame;
+        while (frame.size() < length) {
+            size_t used = frame.size(), n = min(chunk, length - used);
+            frame.resize(used + n);
+            if (!in.read(&frame[used], n)) return false;
+        }
+        inputs.push_back(move(frame));
+    }
+    return true;
+}
@@ -0,0 +1,28 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <istream>
+#include <ostream>
+#include "Compressor.h"
+
+using namespace std;
+
+// JSON container shared by compressor_cli and decompressor_cli: one object
+// per block, optionally wrapped in {"blockSize":N,"blocks":[...]}.
+
+string escape_json(const string &s);
+
+void writeBlockJson(ostream &out, const CompressedBlock &block);
+
+// Parses one block object as written by writeBlockJson(). Malformed input
+// is reported on stderr and returns false; it never throws.
+bool parseBlock(const string &input, CompressedBlock &block);
+
+// Splits the "blocks":[...] array of a multi-block payload into one string
+// per block object. Block objects only nest one level (freqTable).
+bool splitBlocks(const string &input, vector<string> &objects);
+
+// Reads compressor_cli --batch input: a sequence of "<byte length>\n<bytes>"
+// frames, with blank lines between frames ignored. Returns false on a bad
+// length or a truncated frame.
+bool readBatch(istream &in, vector<string> &inputs);
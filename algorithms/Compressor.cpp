@@ -1,71 +1,431 @@
+#include "Compressor.h"
 #include "BWT.h"
 #include "MTF.h"
 #include "RLE.h"
-#include "Huffman.h"
+#include "MtfRle.h"
+#include "Parallel.h"
+#include "Kernels.h"
 #include <iostream>
-#include <string>
-#include<fstream>
+#include <mutex>
+#include <condition_variable>
+#include <map>
+#include <utility>
+#include <chrono>
+#include <cmath>
+#include <algorithm>
 
-using namespace std;
+EntropyCoder &CompressionContext::coder(EntropyBackend backend)
+{
+    if (backend == EntropyBackend::RANS)
+        return rans;
+    return huffman;
+}
+
+// Context for the overloads that do not take one: each thread gets its own,
+// reused across calls and freed when the thread exits.
+static CompressionContext &threadContext()
+{
+    static thread_local CompressionContext context;
+    return context;
+}
+
+CompressedBlock Compressor::compress(const string &input) const
+{
+    cout << "\n========== Compression Pipeline ==========" << endl;
+    CompressedBlock block = compressBlock(input);
+    cout << "[1/3] BWT Transform        ... Done (Primary Index: " << block.primaryIndex << ")" << endl;
+    cout << "[2/3] MTF + Run-Length     ... Done" << endl;
+    if (sharedModel)
+        cout << "[3/3] Entropy Coding (model " << modelId << ") ... Done" << endl;
+    else
+        cout << "[3/3] Entropy Coding (" << entropyBackendName(backend) << ") ... Done" << endl;
+    cout << "==========================================" << endl;
+    cout << "[Info] Compression Primary Index: " << block.primaryIndex << endl;
+    cout << "==========================================\n" << endl;
+    return block;
+}
+
+const string &Compressor::encodeStages(const string &bwt, CompressionContext &context) const
+{
+    uint64_t counts[256];
+    mtfRleEncodeInto(bwt, context.stageBuffer, counts);
+    if (!sharedModel)
+    {
+        // An empty table still replaces the previous call's, so nothing
+        // carries over on a reused context.
+        context.coder(backend).setFrequencyTable(frequenciesFromCounts(counts));
+    }
+    return context.stageBuffer;
+}
+
+CompressedBlock Compressor::compressBlock(const string &input) const
+{
+    return compressBlock(input, threadContext());
+}
 
-class Compressor
+CompressedBlock Compressor::compressBlock(const string &input, CompressionContext &context) const
 {
-private:
-    int primaryIndex; 
-    HuffmanCoding huffman;
+    // Decoders refuse anything larger, so never produce it.
+    if (input.size() > MAX_BLOCK_SIZE)
+        throw runtime_error("Block is larger than 64 MiB; compress it in blocks.");
+    CompressedBlock block;
+    const string &rleResult = encodeStages(bwtEncode(input, block.primaryIndex), context);
+    block.hasChecksum = true;
+    block.checksum = crc32c(reinterpret_cast<const unsigned char *>(input.data()), input.size());
+    block.backend = backend;
+    if (sharedModel)
+    {
+        block.modelId = modelId;
+        block.data = sharedModel->encode(rleResult);
+    }
+    else
+    {
+        EntropyCoder &coder = context.coder(backend);
+        block.data = coder.encode(rleResult);
+        block.freqTable = coder.getFrequencyTable();
+    }
+    return block;
+}
+
+// Estimation parameters: sample count and size, and the context depth of
+// the approximate BWT. Sample prefixes are timed through the real pipeline
+// at doubling sizes from ESTIMATE_PROBE_MIN to ESTIMATE_PROBE_SIZE, stopping
+// early when the next round would overrun ESTIMATE_PROBE_BUDGET seconds:
+// on repetitive data the sort is closer to n^2 log n, and even an 8 KiB
+// probe can take seconds.
+static const size_t ESTIMATE_MAX_SAMPLES = 8;
+static const size_t ESTIMATE_SAMPLE_SIZE = 16 * 1024;
+static const size_t ESTIMATE_BWT_DEPTH = 24;
+static const size_t ESTIMATE_PROBE_MIN = 256;
+static const size_t ESTIMATE_PROBE_SIZE = 8 * 1024;
+static const double ESTIMATE_PROBE_BUDGET = 0.2;
+static const double ESTIMATE_TIME_MARGIN = 1.25;
+
+// Payload bits for symbols with the given histogram: the Shannon bound for
+// the stream's own statistics, or the cross-entropy against a fixed model.
+// Huffman codes cannot go below one bit per symbol.
+static double estimateBits(const uint64_t counts[256], const FrequencyTable *model, bool atLeastOneBit)
+{
+    uint64_t total = 0;
+    for (int s = 0; s < 256; ++s)
+        total += counts[s];
+    if (total == 0)
+        return 0;
+
+    uint64_t modelTotal = 0;
+    if (model)
+        for (auto &entry : *model)
+            modelTotal += entry.second;
+
+    double bits = 0;
+    for (int s = 0; s < 256; ++s)
+    {
+        if (!counts[s])
+            continue;
+        double p = (double)counts[s] / total;
+        if (model)
+        {
+            auto it = model->find((unsigned char)s);
+            p = it == model->end() || it->second == 0 ? 1.0 / 256 : (double)it->second / modelTotal;
+        }
+        bits -= counts[s] * log2(p);
+    }
+    return atLeastOneBit && bits < total ? (double)total : bits;
+}
+
+CompressionEstimate Compressor::estimate(const string &input, size_t blockSize, unsigned threads) const
+{
+    CompressionEstimate result;
+    result.inputSize = input.size();
+    if (input.empty())
+        return result;
+    if (blockSize == 0)
+        blockSize = DEFAULT_BLOCK_SIZE;
+    if (threads == 0)
+        threads = defaultThreadCount();
+
+    size_t sampleSize = min(min(ESTIMATE_SAMPLE_SIZE, blockSize), input.size());
+    size_t samples = min(ESTIMATE_MAX_SAMPLES, (input.size() + sampleSize - 1) / sampleSize);
+    FrequencyTable model;
+    if (sharedModel)
+        model = sharedModel->getFrequencyTable();
+    bool huffmanCodes = sharedModel || backend == EntropyBackend::Huffman;
+
+    CompressionContext context;
+    string symbols;
+    uint64_t counts[256];
+    double bits = 0;
+    vector<string> sampleList;
+    for (size_t k = 0; k < samples; ++k)
+    {
+        size_t offset = samples == 1 ? 0 : (input.size() - sampleSize) * k / (samples - 1);
+        string sample = input.substr(offset, sampleSize);
+
+        mtfRleEncodeInto(bwtEncodeApprox(sample, ESTIMATE_BWT_DEPTH), symbols, counts);
+        double sampleBits = estimateBits(counts, sharedModel ? &model : nullptr, huffmanCodes);
+        double sampleRatio = sampleBits > 0 ? sample.size() * 8.0 / sampleBits : 0;
+        if (k == 0 || sampleRatio < result.ratioMin)
+            result.ratioMin = sampleRatio;
+        if (k == 0 || sampleRatio > result.ratioMax)
+            result.ratioMax = sampleRatio;
+        bits += sampleBits;
+        result.sampledBytes += sample.size();
+        sampleList.push_back(move(sample));
+    }
+    result.samples = samples;
+
+    result.compressedBits = (uint64_t)llround(bits * input.size() / result.sampledBytes);
+    result.ratio = result.compressedBits ? input.size() * 8.0 / result.compressedBits : 0;
+
+    // Probe rounds at doubling sizes. The next round is skipped if, growing
+    // like the last one did (at least 2x), it would overrun the budget.
+    size_t probeSize = 0, previousSize = 0;
+    double roundSeconds = 0, previousSeconds = 0, spent = 0;
+    vector<double> probeTimes;
+    for (size_t size = ESTIMATE_PROBE_MIN;; size *= 2)
+    {
+        size_t next = min(size, min(ESTIMATE_PROBE_SIZE, sampleSize));
+        if (probeSize)
+        {
+            double growth = previousSize ? max(2.0, roundSeconds / previousSeconds) : 4.0;
+            if (next == probeSize || spent + roundSeconds * growth > ESTIMATE_PROBE_BUDGET)
+                break;
+        }
+        vector<double> times;
+        double total = 0;
+        for (const string &sample : sampleList)
+        {
+            string probe = sample.substr(0, next);
+            auto start = chrono::steady_clock::now();
+            compressBlock(probe, context);
+            times.push_back(chrono::duration<double>(chrono::steady_clock::now() - start).count());
+            total += times.back();
+        }
+        previousSize = probeSize;
+        previousSeconds = roundSeconds;
+        probeSize = next;
+        roundSeconds = total;
+        probeTimes = move(times);
+        spent += total;
+    }
 
-public:
-    
-    string compress(const string &input)
+    // The BWT sort grows as n log n times the average comparison length.
+    // That length is flat on typical data, but grows with n on long repeats:
+    // when the last two rounds grew clearly faster than n log n, extrapolate
+    // with their measured exponent instead.
+    size_t blockLength = min(blockSize, input.size());
+    size_t blocks = (input.size() + blockSize - 1) / blockSize;
+    double parallel = (double)min((size_t)threads, blocks);
+    double exponent = 0;
+    if (previousSize > 1 && previousSeconds > 0 && roundSeconds > 0)
     {
-        cout << "\n========== Compression Pipeline ==========" << endl;
-        string bwtResult = bwtEncode(input, primaryIndex);
-        cout << "[1/4] BWT Transform        ... Done (Primary Index: " << primaryIndex << ")" << endl;
-        cout << "[2/4] Move-To-Front (MTF)  ... ";
-        string mtfResult = mtfEncode(bwtResult);
-        cout << "Done" << endl;
-        cout << "[3/4] Run-Length Encoding  ... ";
-        string rleResult = rleEncoded(mtfResult);
-        cout << "Done" << endl;
-        cout << "[4/4] Huffman Coding       ... ";
-        huffman.buildHuffmanTree(rleResult);
-        string compressedData = huffman.encode(rleResult);
-        cout << "Done" << endl;
-        cout << "==========================================" << endl;
-        cout << "[Info] Compression Primary Index: " << primaryIndex << endl;
-        cout << "==========================================\n" << endl;
-        return compressedData;
+        double measured = log2(roundSeconds / previousSeconds) / log2((double)probeSize / previousSize);
+        double nLogN = 1 + log2(log2((double)probeSize) / log2((double)previousSize)) / log2((double)probeSize / previousSize);
+        if (measured > nLogN + 0.3)
+            exponent = min(measured, 2.5);
     }
+    double reach = probeSize > 0 ? (double)blockLength / probeSize : 1.0;
+    double scale = exponent > 0 ? pow(reach, exponent - 1)
+                   : probeSize > 1 && blockLength > 1 ? log2((double)blockLength) / log2((double)probeSize)
+                                                      : 1.0;
+    auto predict = [&](double seconds) { return seconds / probeSize * scale * input.size() / parallel; };
 
-    // Decompress input string using the pipeline
-    string decompress(const string &compressed, int primaryIndex)
+    result.seconds = predict(roundSeconds / samples);
+    result.secondsMin = result.secondsMax = result.seconds;
+    for (double seconds : probeTimes)
     {
-        cerr << "\n======== Decompression Pipeline =========" << endl;
-        cerr << "[Info] Using Primary Index: " << primaryIndex << endl;
-        cerr << "[1/4] Huffman Decoding     ... ";
-        string rleResult = huffman.decode(compressed);
-        cerr << "Done" << endl;
-        cerr << "[2/4] RLE Decoding         ... ";
-        string mtfResult = rleDecoded(rleResult);
-        cerr << "Done" << endl;
-        cerr << "[3/4] MTF Decoding         ... ";
-        string bwtResult = mtfDecode(mtfResult);
-        cerr << "Done" << endl;
-        cerr << "[4/4] BWT Inverse Transform... ";
-        string originalText = bwtDecode(bwtResult, primaryIndex);
-        cerr << "Done" << endl;
-        cerr << "==========================================" << endl;
-        cerr << "[Info] Decompression Primary Index: " << primaryIndex << endl;
-        cerr << "==========================================\n" << endl;
-        return originalText;
+        result.secondsMin = min(result.secondsMin, predict(seconds));
+        result.secondsMax = max(result.secondsMax, predict(seconds));
     }
+    // Samples can agree and still miss repeats longer than a probe; measured
+    // error beyond the sample spread stays within 25%. A fitted exponent is
+    // only good to about +-0.2 over the extrapolated range.
+    double margin = ESTIMATE_TIME_MARGIN * (exponent > 0 && reach > 1 ? pow(reach, 0.2) : 1.0);
+    result.secondsMin /= margin;
+    result.secondsMax *= margin;
+    return result;
+}
+
+vector<CompressedBlock> Compressor::compressBatch(const vector<string> &inputs, unsigned threads) const
+{
+    if (threads == 0)
+        threads = defaultThreadCount();
+    if (threads > inputs.size())
+        threads = inputs.empty() ? 1 : (unsigned)inputs.size();
+
+    vector<CompressionContext> contexts(threads);
+
+    vector<CompressedBlock> results(inputs.size());
+    parallelFor(inputs.size(), threads, [&](size_t i, unsigned worker)
+                { results[i] = compressBlock(inputs[i], contexts[worker]); });
+    return results;
+}
+
+vector<CompressedBlock> Compressor::compressBlocks(const string &input, size_t blockSize,
+                                                   const ProgressCallback &progress,
+                                                   const atomic<bool> *cancel, unsigned threads) const
+{
+    if (blockSize == 0)
+        blockSize = DEFAULT_BLOCK_SIZE;
+    size_t total = input.empty() ? 1 : (input.size() + blockSize - 1) / blockSize;
+    if (threads == 0)
+        threads = defaultThreadCount();
+    if (threads > total)
+        threads = (unsigned)total;
 
-    int getPrimaryIndex() const
+    vector<CompressionContext> contexts(threads);
+
+    vector<CompressedBlock> results(total);
+    size_t done = 0;
+    mutex progressMutex;
+    parallelFor(total, threads, [&](size_t i, unsigned worker)
+                {
+                    if (cancel && *cancel)
+                        throw CompressionCancelled();
+                    results[i] = compressBlock(input.substr(i * blockSize, blockSize), contexts[worker]);
+                    if (progress)
+                    {
+                        lock_guard<mutex> lock(progressMutex);
+                        progress(++done, total);
+                    }
+                });
+    return results;
+}
+
+string Compressor::decompressBlock(const CompressedBlock &block) const
+{
+    return decompressBlock(block, threadContext());
+}
+
+string Compressor::decompressBlock(const CompressedBlock &block, CompressionContext &context) const
+{
+    string rleResult;
+    if (!block.modelId.empty())
+    {
+        if (!sharedModel || block.modelId != modelId)
+            throw runtime_error("Block needs model '" + block.modelId + "' which is not loaded.");
+        rleResult = sharedModel->decode(block.data);
+    }
+    else if (!block.freqTable.empty())
     {
-        return primaryIndex;
+        EntropyCoder &coder = context.coder(block.backend);
+        coder.setFrequencyTable(block.freqTable);
+        rleResult = coder.decode(block.data);
     }
+    else if (!block.data.empty())
+    {
+        throw runtime_error("Block has neither a frequency table nor a model.");
+    }
+    if (rleDecodedSize(rleResult) > MAX_BLOCK_SIZE)
+        throw runtime_error("Block decodes to more than 64 MiB.");
+    string bwtResult = mtfDecode(rleDecoded(rleResult));
+    string output;
+    if (lowMemory)
+    {
+        string().swap(rleResult);
+        output = bwtDecodeLowMemory(bwtResult, block.primaryIndex);
+    }
+    else
+    {
+        output = bwtDecode(bwtResult, block.primaryIndex);
+    }
+    if (block.hasChecksum &&
+        crc32c(reinterpret_cast<const unsigned char *>(output.data()), output.size()) != block.checksum)
+        throw runtime_error("Block checksum mismatch.");
+    return output;
+}
+
+void Compressor::decompressBlocks(const vector<CompressedBlock> &blocks, const BlockSink &sink,
+                                  unsigned threads, size_t maxPending) const
+{
+    if (blocks.empty())
+        return;
+    if (threads == 0)
+        threads = defaultThreadCount();
+    if (threads > blocks.size())
+        threads = (unsigned)blocks.size();
+    if (maxPending == 0)
+        maxPending = 2 * (size_t)threads;
+
+    vector<CompressionContext> contexts(threads);
 
-    HuffmanCoding& getHuffman() { return huffman; }
-    void setHuffman(const HuffmanCoding& h) { huffman = h; }
-};
+    // parallelFor hands out indices in order, so the block the writer needs
+    // next is always in flight and never waits on the window.
+    mutex reorderMutex;
+    condition_variable windowOpen;
+    map<size_t, string> pending;
+    size_t nextToWrite = 0;
+    bool writing = false, aborted = false;
 
+    parallelFor(blocks.size(), threads, [&](size_t i, unsigned worker)
+                {
+                    try
+                    {
+                        {
+                            unique_lock<mutex> lock(reorderMutex);
+                            windowOpen.wait(lock, [&]
+                                            { return aborted || i < nextToWrite + maxPending; });
+                            if (aborted)
+                                return;
+                        }
+                        string output = decompressBlock(blocks[i], contexts[worker]);
+
+                        unique_lock<mutex> lock(reorderMutex);
+                        pending[i] = move(output);
+                        if (writing)
+                            return; // the active writer will pick it up
+                        writing = true;
+                        while (!aborted && pending.count(nextToWrite))
+                        {
+                            string chunk = move(pending[nextToWrite]);
+                            pending.erase(nextToWrite);
+                            lock.unlock();
+                            sink(chunk);
+                            lock.lock();
+                            ++nextToWrite;
+                            windowOpen.notify_all();
+                        }
+                        writing = false;
+                    }
+                    catch (...)
+                    {
+                        // Wake workers waiting on the window so parallelFor
+                        // can stop and rethrow.
+                        lock_guard<mutex> lock(reorderMutex);
+                        aborted = true;
+                        windowOpen.notify_all();
+                        throw;
+                    }
+                });
+}
+
+string Compressor::decompress(const CompressedBlock &block) const
+{
+    cerr << "\n======== Decompression Pipeline =========" << endl;
+    cerr << "[Info] Using Primary Index: " << block.primaryIndex << endl;
+    string originalText = decompressBlock(block);
+    if (block.modelId.empty())
+        cerr << "[1/4] Entropy Decoding (" << entropyBackendName(block.backend) << ") ... Done" << endl;
+    else
+        cerr << "[1/4] Entropy Decoding (model " << block.modelId << ") ... Done" << endl;
+    cerr << "[2/4] RLE Decoding         ... Done" << endl;
+    cerr << "[3/4] MTF Decoding         ... Done" << endl;
+    cerr << "[4/4] BWT Inverse Transform... Done" << endl;
+    cerr << "==========================================" << endl;
+    cerr << "[Info] Decompression Primary Index: " << block.primaryIndex << endl;
+    cerr << "==========================================\n" << endl;
+    return originalText;
+}
+
+void Compressor::useModel(const string &id, const HuffmanCoding *model)
+{
+    modelId = id;
+    sharedModel = model;
+    backend = EntropyBackend::Huffman;
+}
+
+void Compressor::clearModel()
+{
+    modelId.clear();
+    sharedModel = nullptr;
+}
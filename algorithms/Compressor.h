@@ -1,5 +1,160 @@
-#include <map>
- 
+#ifndef COMPRESSOR_H
+#define COMPRESSOR_H
+
+#include <string>
+#include <vector>
+#include <atomic>
+#include <functional>
+#include <stdexcept>
+#include "Huffman.h"
+#include "RANS.h"
+
+using namespace std;
+
+// Inputs larger than this are split into independently compressed blocks.
+const size_t DEFAULT_BLOCK_SIZE = 256 * 1024;
+
+// Thrown when a caller-owned cancel flag is raised mid-compression.
+class CompressionCancelled : public runtime_error
+{
 public:
-    HuffmanCoding& getHuffman() { return huffman; }
-    void setHuffman(const HuffmanCoding& h) { huffman = h; } 
\ No newline at end of file
+    CompressionCancelled() : runtime_error("Compression cancelled.") {}
+};
+
+// Called with (blocks finished, total blocks) after every block.
+typedef function<void(size_t, size_t)> ProgressCallback;
+
+// Receives decompressed blocks one at a time, in block order.
+typedef function<void(const string &)> BlockSink;
+
+// Everything a decompressor needs for one independently compressed input.
+struct CompressedBlock
+{
+    string data;
+    size_t primaryIndex = 0;
+    EntropyBackend backend = EntropyBackend::Huffman;
+    string modelId;
+    FrequencyTable freqTable;
+    // CRC-32C of the original block, checked after decompression.
+    bool hasChecksum = false;
+    uint32_t checksum = 0;
+};
+
+// Prediction from Compressor::estimate(). Ratios are original bits per
+// compressed payload bit, as the benchmark reports them.
+struct CompressionEstimate
+{
+    size_t inputSize = 0;
+    size_t samples = 0;
+    size_t sampledBytes = 0;
+    double ratio = 0;
+    // Spread of the per-sample ratios, a rough tolerance for ratio.
+    double ratioMin = 0;
+    double ratioMax = 0;
+    uint64_t compressedBits = 0;
+    // Predicted wall time of compressBlocks() with the same block size and
+    // thread count on this machine. Sorting cost depends on how repetitive
+    // the data is, so treat the time as the range secondsMin-secondsMax: the
+    // per-sample predictions widened by 25%, and further when the probes
+    // showed faster than n log n growth.
+    double seconds = 0;
+    double secondsMin = 0;
+    double secondsMax = 0;
+};
+
+// Per-call working state: the coder tables built for one block and the
+// stage buffer they are built from. Keep one per thread and reuse it so the
+// buffers keep their capacity; a context must not be used by two calls at
+// once.
+struct CompressionContext
+{
+    HuffmanCoding huffman;
+    RansCoding rans;
+    string stageBuffer;
+
+    EntropyCoder &coder(EntropyBackend backend);
+};
+
+// BWT -> MTF -> RLE -> entropy coding pipeline. A Compressor only holds
+// configuration; every compression method is const and keeps its working
+// state in a CompressionContext, so one instance can serve any number of
+// threads without locking. Configure it (backend, model, low-memory mode)
+// before sharing it.
+class Compressor
+{
+private:
+    EntropyBackend backend;
+    const HuffmanCoding *sharedModel;
+    string modelId;
+    bool lowMemory;
+
+    // Runs the fused MTF+RLE stage over bwt into context.stageBuffer and,
+    // unless a shared model is in use, builds the context's coder from its
+    // histogram.
+    const string &encodeStages(const string &bwt, CompressionContext &context) const;
+
+public:
+    Compressor(EntropyBackend backend = EntropyBackend::Huffman) : backend(backend), sharedModel(nullptr), lowMemory(false) {}
+
+    // compressBlock() with a stage-by-stage log on stdout.
+    CompressedBlock compress(const string &input) const;
+
+    // Compresses one input into a self-describing block. The first form
+    // uses a context owned by the calling thread.
+    CompressedBlock compressBlock(const string &input) const;
+    CompressedBlock compressBlock(const string &input, CompressionContext &context) const;
+
+    // Compresses many independent inputs at once. Each worker thread owns
+    // one context and reuses it for every input it picks up; outputs keep
+    // the order of the inputs.
+    vector<CompressedBlock> compressBatch(const vector<string> &inputs, unsigned threads = 0) const;
+
+    // Splits the input into blockSize chunks and compresses them in
+    // parallel. progress is reported once per finished block, and cancel is
+    // polled before each block starts; raising it aborts with
+    // CompressionCancelled once in-flight blocks finish.
+    vector<CompressedBlock> compressBlocks(const string &input, size_t blockSize = DEFAULT_BLOCK_SIZE,
+                                           const ProgressCallback &progress = nullptr,
+                                           const atomic<bool> *cancel = nullptr, unsigned threads = 0) const;
+
+    // Predicts the compressed size and compression time of input without
+    // compressing it: up to 8 evenly spaced 16 KiB samples go through a
+    // depth-limited BWT and the fused MTF+RLE stage, and the entropy of the
+    // result under the active coder (or shared model) gives the size. Time
+    // comes from running the real pipeline on sample prefixes of doubling
+    // size, up to 8 KiB or a fixed time budget, and scaling the last round
+    // to the block size with the growth rate the rounds showed.
+    CompressionEstimate estimate(const string &input, size_t blockSize = DEFAULT_BLOCK_SIZE, unsigned threads = 0) const;
+
+    // Inverse of compressBlock(). Blocks that reference a shared model need
+    // the same model installed with useModel().
+    string decompressBlock(const CompressedBlock &block) const;
+    string decompressBlock(const CompressedBlock &block, CompressionContext &context) const;
+
+    // Decompresses blocks in parallel and hands each result to sink in
+    // block order. Finished blocks wait in a reorder buffer of at most
+    // maxPending entries (0 means twice the thread count); workers that
+    // get that far ahead of the writer block until it catches up.
+    void decompressBlocks(const vector<CompressedBlock> &blocks, const BlockSink &sink,
+                          unsigned threads = 0, size_t maxPending = 0) const;
+
+    // decompressBlock() with a stage-by-stage log on stderr.
+    string decompress(const CompressedBlock &block) const;
+
+    // Decode blocks with bwtDecodeLowMemory() and release each stage's
+    // buffer as soon as the next one is built.
+    bool getLowMemory() const { return lowMemory; }
+    void setLowMemory(bool enabled) { lowMemory = enabled; }
+
+    EntropyBackend getEntropyBackend() const { return backend; }
+    void setEntropyBackend(EntropyBackend b) { backend = b; }
+
+    // Encode and decode with a prebuilt shared model instead of building
+    // and shipping a table per payload. The model must outlive its use here.
+    void useModel(const string &id, const HuffmanCoding *model);
+    void clearModel();
+    bool hasModel() const { return sharedModel != nullptr; }
+    const string &getModelId() const { return modelId; }
+};
+
+#endif
@@ -0,0 +1,47 @@
+#include "EntropyCoder.h"
+#include "Kernels.h"
+
+FrequencyTable countFrequencies(const string &text)
+{
+    uint64_t counts[256] = {};
+    kernels().histogram(reinterpret_cast<const unsigned char *>(text.data()), text.size(), counts);
+    return frequenciesFromCounts(counts);
+}
+
+FrequencyTable frequenciesFromCounts(const uint64_t counts[256])
+{
+    FrequencyTable freq;
+    for (int s = 0; s < 256; ++s)
+    {
+        if (counts[s])
+            freq[(unsigned char)s] = counts[s];
+    }
+    return freq;
+}
+
+const char *entropyBackendName(EntropyBackend backend)
+{
+    switch (backend)
+    {
+    case EntropyBackend::RANS:
+        return "rans";
+    case EntropyBackend::Huffman:
+    default:
+        return "huffman";
+    }
+}
+
+bool parseEntropyBackend(const string &name, EntropyBackend &backend)
+{
+    if (name == "huffman")
+    {
+        backend = EntropyBackend::Huffman;
+        return true;
+    }
+    if (name == "rans")
+    {
+        backend = EntropyBackend::RANS;
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include <string>
+#include <map>
+#include <cstdint>
+
+using namespace std;
+
+// Symbol counts are 64-bit so multi-gigabyte blocks cannot overflow them.
+typedef map<unsigned char, uint64_t> FrequencyTable;
+
+// Largest block the pipeline compresses or accepts for decompression.
+// Sizes taken from a payload are checked against these before anything is
+// allocated; the entropy stage sees RLE (count, byte) pairs, at most two
+// symbols per input byte.
+const uint64_t MAX_BLOCK_SIZE = 64ull << 20;
+const uint64_t MAX_ENTROPY_SYMBOLS = 2 * MAX_BLOCK_SIZE;
+
+// Final stage of the pipeline. Every backend emits its payload as a '0'/'1'
+// bit string so the CLIs and the server can carry it the same way.
+class EntropyCoder
+{
+public:
+    virtual ~EntropyCoder() {}
+
+    virtual void buildModel(const string &text) = 0;
+    virtual string encode(const string &text) const = 0;
+    virtual string decode(const string &encodedStr) const = 0;
+
+    virtual FrequencyTable getFrequencyTable() const = 0;
+    virtual void setFrequencyTable(const FrequencyTable &table) = 0;
+
+    virtual const char *name() const = 0;
+};
+
+// Byte histogram of text, as consumed by every backend's buildModel().
+FrequencyTable countFrequencies(const string &text);
+
+// Table form of a raw 256-entry histogram; zero counts are dropped.
+FrequencyTable frequenciesFromCounts(const uint64_t counts[256]);
+
+enum class EntropyBackend
+{
+    Huffman,
+    RANS
+};
+
+const char *entropyBackendName(EntropyBackend backend);
+bool parseEntropyBackend(const string &name, EntropyBackend &backend);
@@ -1,5 +1,6 @@
 #include "Huffman.h"
 #include <map>
+#include "Kernels.h"
 
 HuffmanCoding::HuffmanCoding(){
     root = nullptr;
@@ -8,36 +9,36 @@ HuffmanCoding:: ~HuffmanCoding(){
     freeTree(root);
 }
 
+HuffmanCoding::HuffmanCoding(const HuffmanCoding &other)
+    : root(copyTree(other.root)), codes(other.codes), reverseCodes(other.reverseCodes), freqTable(other.freqTable) {}
+
+HuffmanCoding &HuffmanCoding::operator=(const HuffmanCoding &other){
+    if(this == &other) return *this;
+    Node *copy = copyTree(other.root);
+    freeTree(root);
+    root = copy;
+    codes = other.codes;
+    reverseCodes = other.reverseCodes;
+    freqTable = other.freqTable;
+    return *this;
+}
+
 void HuffmanCoding :: buildHuffmanTree(const string &text){
     if(text.empty()){
         cerr << "[Error] Input text is empty . \n";
         return;
     }
-    map<unsigned char , int> freq;
-    for(unsigned char ch : text){
-        freq[ch]++;
-    }
-    freqTable = freq;
-    priority_queue<Node*  , vector <Node*> , Compare> pq;
-    for(auto pair : freq){
-        pq.push(new Node(pair.first , pair.second));
-    }
-    while(pq.size() > 1){
-        Node *left = pq.top();
-        pq.pop();
-        Node *right = pq.top();
-        pq.pop();
-        Node *merged = new Node('\0' , left->freq + right->freq);
-        merged->left = left;
-        merged->right = right;
-        pq.push(merged);
-    }
-    root = pq.top();
-    buildCodes(root , "");
+    setFrequencyTable(countFrequencies(text));
 }
 
-void HuffmanCoding::setFrequencyTable(const map<unsigned char, int>& table) {
+void HuffmanCoding::setFrequencyTable(const FrequencyTable& table) {
+    freeTree(root);
+    root = nullptr;
+    codes.clear();
+    reverseCodes.clear();
     freqTable = table;
+    if (freqTable.empty()) return;
+
     priority_queue<Node*, vector<Node*>, Compare> pq;
     for (auto pair : freqTable) {
         pq.push(new Node(pair.first, pair.second));
@@ -51,9 +52,8 @@ void HuffmanCoding::setFrequencyTable(const map<unsigned char, int>& table) {
         pq.push(merged);
     }
     root = pq.top();
-    codes.clear();
-    reverseCodes.clear();
-    buildCodes(root, "");
+    // A lone symbol still needs a one-bit code, or its text would encode to nothing.
+    buildCodes(root, root->left ? "" : "0");
 }
 
 void HuffmanCoding::buildCodes(Node* node , string str){
@@ -66,20 +66,31 @@ void HuffmanCoding::buildCodes(Node* node , string str){
     buildCodes(node->right , str+"1");
 }
 
-string HuffmanCoding::encode(const string &text){
+string HuffmanCoding::encode(const string &text) const{
     if(text.empty()) return "";
     string encoded;
     for(unsigned char ch : text){
-        encoded += codes[ch];
+        auto it = codes.find(ch);
+        if(it == codes.end()) throw runtime_error("Symbol not present in Huffman table.\n");
+        encoded += it->second;
     }
     return encoded;
 }
 
-string HuffmanCoding::decode(const string &encodedStr){
+string HuffmanCoding::decode(const string &encodedStr) const{
     if(encodedStr.empty()) return "";
 
+    if(!root) throw runtime_error("Huffman table is empty.\n");
     string decoded;
     Node* current = root;
+    if(!root->left){
+        // Single-symbol table: every '0' bit is one symbol.
+        for(char bit : encodedStr){
+            if(bit != '0') throw runtime_error("Invalid encoded data.\n");
+            decoded += root->ch;
+        }
+        return decoded;
+    }
 
     for(char bit : encodedStr){
         if(bit == '0')
@@ -114,27 +125,9 @@ bool HuffmanCoding::compressToFile(const string &inputText, const string &filena
     saveFrequencyTable(outFile);
 
     string encoded = encode(inputText);
-    unsigned char byte = 0;
-    int bitCount = 0;
-
-    for (char bit : encoded)
-    {
-        byte = (byte << 1) | (bit - '0'); 
-        bitCount++;
-
-        if (bitCount == 8)
-        {
-            outFile.put(byte);
-            byte = 0;
-            bitCount = 0;
-        }
-    }
-    
-    if (bitCount > 0)
-    {
-        byte <<= (8 - bitCount);
-        outFile.put(byte);
-    }
+    string packed((encoded.size() + 7) / 8, '\0');
+    kernels().packBits(encoded.data(), encoded.size(), reinterpret_cast<unsigned char *>(&packed[0]));
+    outFile.write(packed.data(), packed.size());
 
     outFile.close();
     size_t originalBits = inputText.size() * 8;
@@ -163,16 +156,12 @@ bool HuffmanCoding::decompressFromFile(const string &filename, string &outputTex
 
     loadFrequencyTable(inFile);
 
-    string encoded = "";
-    char byte;
-    while (inFile.get(byte))
-    {
-        for (int i = 7; i >= 0; --i)
-        {
-            encoded += ((byte >> i) & 1) ? '1' : '0';
-        }
-    }
+    stringstream packed;
+    packed << inFile.rdbuf();
     inFile.close();
+    string bytes = packed.str();
+    string encoded(bytes.size() * 8, '0');
+    kernels().unpackBits(reinterpret_cast<const unsigned char *>(bytes.data()), bytes.size(), &encoded[0]);
 
     try
     {
@@ -188,6 +177,14 @@ bool HuffmanCoding::decompressFromFile(const string &filename, string &outputTex
     return true;
 }
 
+Node *HuffmanCoding::copyTree(const Node *node){
+    if(!node) return nullptr;
+    Node *copy = new Node(node->ch, node->freq);
+    copy->left = copyTree(node->left);
+    copy->right = copyTree(node->right);
+    return copy;
+}
+
 void HuffmanCoding::freeTree(Node* node){
     if(!node) return;
     freeTree(node->left);
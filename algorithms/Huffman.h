@@ -7,16 +7,17 @@
 #include <fstream>
 #include <sstream>
 #include <map>
+#include "EntropyCoder.h"
 
 using namespace std;
 
 struct Node
 {
     unsigned char ch;
-    int freq;
+    uint64_t freq;
     Node *left, *right;
 
-    Node(unsigned char c, int f) : ch(c), freq(f), left(nullptr), right(nullptr) {}
+    Node(unsigned char c, uint64_t f) : ch(c), freq(f), left(nullptr), right(nullptr) {}
 };
 
 struct Compare
@@ -29,33 +30,40 @@ struct Compare
     }
 };
 
-class HuffmanCoding
+class HuffmanCoding : public EntropyCoder
 {
 
 private:
     Node *root;
     unordered_map<unsigned char, string> codes;
     unordered_map<string, unsigned char> reverseCodes;
-    map<unsigned char, int> freqTable;
+    FrequencyTable freqTable;
 
     void buildCodes(Node *node, string str);
     void freeTree(Node *node);
+    static Node *copyTree(const Node *node);
     void saveFrequencyTable(ofstream &outFile);
     void loadFrequencyTable(ifstream &inFile);
 
 public:
     HuffmanCoding();
     ~HuffmanCoding();
+    // Copies own a separate tree, so either side can be rebuilt or destroyed.
+    HuffmanCoding(const HuffmanCoding &other);
+    HuffmanCoding &operator=(const HuffmanCoding &other);
 
     void buildHuffmanTree(const string &text);
-    string encode(const string &text);
-    string decode(const string &encodedStr);
+    void buildModel(const string &text) override { buildHuffmanTree(text); }
+    string encode(const string &text) const override;
+    string decode(const string &encodedStr) const override;
 
     bool compressToFile(const string &inputText, const string &filename);
     bool decompressFromFile(const string &filename, string &outputText);
 
-    map<unsigned char, int> getFrequencyTable() const { return freqTable; }
-    void setFrequencyTable(const map<unsigned char, int>& table);
+    FrequencyTable getFrequencyTable() const override { return freqTable; }
+    void setFrequencyTable(const FrequencyTable& table) override;
+
+    const char *name() const override { return "huffman"; }
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,386 @@
+#include "Kernels.h"
+#include <cstring>
+#include <cstdlib>
+#include <string>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define MLC_X86_KERNELS 1
+#include <immintrin.h>
+#endif
+
+// ---------------------------------------------------------------------------
+// Scalar kernels (every platform)
+// ---------------------------------------------------------------------------
+
+static size_t findByteScalar(const unsigned char *data, size_t n, unsigned char value)
+{
+    const void *hit = memchr(data, value, n);
+    return hit ? (size_t)((const unsigned char *)hit - data) : n;
+}
+
+static size_t runLengthScalar(const unsigned char *data, size_t n, unsigned char value)
+{
+    size_t i = 0;
+    while (i < n && data[i] == value)
+        ++i;
+    return i;
+}
+
+// Four interleaved count tables so consecutive equal bytes (the common case
+// after MTF) do not serialise on one counter. Byte histograms scatter, so
+// there is no profitable vector form; every tier shares this one.
+static void histogramScalar(const unsigned char *data, size_t n, uint64_t counts[256])
+{
+    uint64_t partial[4][256] = {};
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+        partial[0][data[i]]++;
+        partial[1][data[i + 1]]++;
+        partial[2][data[i + 2]]++;
+        partial[3][data[i + 3]]++;
+    }
+    for (; i < n; ++i)
+        partial[0][data[i]]++;
+    for (int s = 0; s < 256; ++s)
+        counts[s] += partial[0][s] + partial[1][s] + partial[2][s] + partial[3][s];
+}
+
+static bool packBitsScalar(const char *bits, size_t n, unsigned char *out)
+{
+    unsigned char byte = 0;
+    size_t i = 0;
+    for (; i < n; ++i)
+    {
+        char bit = bits[i];
+        if (bit != '0' && bit != '1')
+            return false;
+        byte = (byte << 1) | (bit - '0');
+        if ((i & 7) == 7)
+        {
+            out[i >> 3] = byte;
+            byte = 0;
+        }
+    }
+    if (n & 7)
+        out[n >> 3] = byte << (8 - (n & 7));
+    return true;
+}
+
+struct UnpackTable
+{
+    char bits[256][8];
+    UnpackTable()
+    {
+        for (int b = 0; b < 256; ++b)
+            for (int i = 0; i < 8; ++i)
+                bits[b][i] = ((b >> (7 - i)) & 1) ? '1' : '0';
+    }
+};
+
+static void unpackBitsTable(const unsigned char *bytes, size_t n, char *out)
+{
+    static const UnpackTable table;
+    for (size_t i = 0; i < n; ++i)
+        memcpy(out + 8 * i, table.bits[bytes[i]], 8);
+}
+
+struct Crc32cTable
+{
+    uint32_t entries[256];
+    Crc32cTable()
+    {
+        for (uint32_t b = 0; b < 256; ++b)
+        {
+            uint32_t crc = b;
+            for (int k = 0; k < 8; ++k)
+                crc = (crc >> 1) ^ (0x82F63B78u & (0u - (crc & 1)));
+            entries[b] = crc;
+        }
+    }
+};
+
+static uint32_t crc32cScalar(uint32_t crc, const unsigned char *data, size_t n)
+{
+    static const Crc32cTable table;
+    for (size_t i = 0; i < n; ++i)
+        crc = table.entries[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    return crc;
+}
+
+#ifdef MLC_X86_KERNELS
+
+// ---------------------------------------------------------------------------
+// SSE4.2 (16 bytes per step)
+// ---------------------------------------------------------------------------
+
+__attribute__((target("sse4.2"))) static size_t findByteSSE42(const unsigned char *data, size_t n, unsigned char value)
+{
+    const __m128i needle = _mm_set1_epi8((char)value);
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16)
+    {
+        __m128i chunk = _mm_loadu_si128((const __m128i *)(data + i));
+        unsigned mask = (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, needle));
+        if (mask)
+            return i + __builtin_ctz(mask);
+    }
+    return i + findByteScalar(data + i, n - i, value);
+}
+
+__attribute__((target("sse4.2"))) static size_t runLengthSSE42(const unsigned char *data, size_t n, unsigned char value)
+{
+    const __m128i needle = _mm_set1_epi8((char)value);
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16)
+    {
+        __m128i chunk = _mm_loadu_si128((const __m128i *)(data + i));
+        unsigned mismatch = ~(unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, needle)) & 0xFFFFu;
+        if (mismatch)
+            return i + __builtin_ctz(mismatch);
+    }
+    return i + runLengthScalar(data + i, n - i, value);
+}
+
+// movemask yields the first character in bit 0, but packed bytes are MSB
+// first, so each 8-character group is reversed before the mask is taken.
+__attribute__((target("sse4.2"))) static bool packBitsSSE42(const char *bits, size_t n, unsigned char *out)
+{
+    const __m128i zero = _mm_set1_epi8('0');
+    const __m128i one = _mm_set1_epi8('1');
+    const __m128i reverse = _mm_setr_epi8(7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8);
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16)
+    {
+        __m128i chunk = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(bits + i)), reverse);
+        __m128i isOne = _mm_cmpeq_epi8(chunk, one);
+        __m128i valid = _mm_or_si128(isOne, _mm_cmpeq_epi8(chunk, zero));
+        if (_mm_movemask_epi8(valid) != 0xFFFF)
+            return false;
+        uint16_t mask = (uint16_t)_mm_movemask_epi8(isOne);
+        memcpy(out + i / 8, &mask, 2);
+    }
+    return packBitsScalar(bits + i, n - i, out + i / 8);
+}
+
+__attribute__((target("sse4.2"))) static uint32_t crc32cSSE42(uint32_t crc, const unsigned char *data, size_t n)
+{
+#if defined(__x86_64__)
+    uint64_t wide = crc;
+    for (; n >= 8; n -= 8, data += 8)
+    {
+        uint64_t word;
+        memcpy(&word, data, 8);
+        wide = _mm_crc32_u64(wide, word);
+    }
+    crc = (uint32_t)wide;
+#endif
+    for (; n >= 4; n -= 4, data += 4)
+    {
+        uint32_t word;
+        memcpy(&word, data, 4);
+        crc = _mm_crc32_u32(crc, word);
+    }
+    for (; n > 0; --n, ++data)
+        crc = _mm_crc32_u8(crc, *data);
+    return crc;
+}
+
+// ---------------------------------------------------------------------------
+// AVX2 (32 bytes per step)
+// ---------------------------------------------------------------------------
+
+__attribute__((target("avx2"))) static size_t findByteAVX2(const unsigned char *data, size_t n, unsigned char value)
+{
+    const __m256i needle = _mm256_set1_epi8((char)value);
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32)
+    {
+        __m256i chunk = _mm256_loadu_si256((const __m256i *)(data + i));
+        unsigned mask = (unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, needle));
+        if (mask)
+            return i + __builtin_ctz(mask);
+    }
+    return i + findByteSSE42(data + i, n - i, value);
+}
+
+__attribute__((target("avx2"))) static size_t runLengthAVX2(const unsigned char *data, size_t n, unsigned char value)
+{
+    const __m256i needle = _mm256_set1_epi8((char)value);
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32)
+    {
+        __m256i chunk = _mm256_loadu_si256((const __m256i *)(data + i));
+        unsigned mismatch = ~(unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, needle));
+        if (mismatch)
+            return i + __builtin_ctz(mismatch);
+    }
+    return i + runLengthSSE42(data + i, n - i, value);
+}
+
+__attribute__((target("avx2"))) static bool packBitsAVX2(const char *bits, size_t n, unsigned char *out)
+{
+    const __m256i zero = _mm256_set1_epi8('0');
+    const __m256i one = _mm256_set1_epi8('1');
+    const __m256i reverse = _mm256_setr_epi8(7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8,
+                                             7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8);
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32)
+    {
+        __m256i chunk = _mm256_shuffle_epi8(_mm256_loadu_si256((const __m256i *)(bits + i)), reverse);
+        __m256i isOne = _mm256_cmpeq_epi8(chunk, one);
+        __m256i valid = _mm256_or_si256(isOne, _mm256_cmpeq_epi8(chunk, zero));
+        if ((unsigned)_mm256_movemask_epi8(valid) != 0xFFFFFFFFu)
+            return false;
+        uint32_t mask = (uint32_t)_mm256_movemask_epi8(isOne);
+        memcpy(out + i / 8, &mask, 4);
+    }
+    return packBitsSSE42(bits + i, n - i, out + i / 8);
+}
+
+// ---------------------------------------------------------------------------
+// AVX-512BW (64 bytes per step)
+// ---------------------------------------------------------------------------
+
+__attribute__((target("avx512f,avx512bw"))) static size_t findByteAVX512(const unsigned char *data, size_t n, unsigned char value)
+{
+    const __m512i needle = _mm512_set1_epi8((char)value);
+    size_t i = 0;
+    for (; i + 64 <= n; i += 64)
+    {
+        __m512i chunk = _mm512_loadu_si512((const void *)(data + i));
+        uint64_t mask = _mm512_cmpeq_epi8_mask(chunk, needle);
+        if (mask)
+            return i + __builtin_ctzll(mask);
+    }
+    return i + findByteAVX2(data + i, n - i, value);
+}
+
+__attribute__((target("avx512f,avx512bw"))) static size_t runLengthAVX512(const unsigned char *data, size_t n, unsigned char value)
+{
+    const __m512i needle = _mm512_set1_epi8((char)value);
+    size_t i = 0;
+    for (; i + 64 <= n; i += 64)
+    {
+        __m512i chunk = _mm512_loadu_si512((const void *)(data + i));
+        uint64_t mismatch = _mm512_cmpneq_epi8_mask(chunk, needle);
+        if (mismatch)
+            return i + __builtin_ctzll(mismatch);
+    }
+    return i + runLengthAVX2(data + i, n - i, value);
+}
+
+__attribute__((target("avx512f,avx512bw"))) static bool packBitsAVX512(const char *bits, size_t n, unsigned char *out)
+{
+    const __m512i zero = _mm512_set1_epi8('0');
+    const __m512i one = _mm512_set1_epi8('1');
+    // Bytes 7..0 then 15..8 in every 128-bit lane, as 64-bit lanes.
+    const __m512i reverse = _mm512_set_epi64(0x08090a0b0c0d0e0fLL, 0x0001020304050607LL,
+                                             0x08090a0b0c0d0e0fLL, 0x0001020304050607LL,
+                                             0x08090a0b0c0d0e0fLL, 0x0001020304050607LL,
+                                             0x08090a0b0c0d0e0fLL, 0x0001020304050607LL);
+    size_t i = 0;
+    for (; i + 64 <= n; i += 64)
+    {
+        __m512i chunk = _mm512_shuffle_epi8(_mm512_loadu_si512((const void *)(bits + i)), reverse);
+        uint64_t isOne = _mm512_cmpeq_epi8_mask(chunk, one);
+        uint64_t isZero = _mm512_cmpeq_epi8_mask(chunk, zero);
+        if ((isOne | isZero) != ~0ULL)
+            return false;
+        memcpy(out + i / 8, &isOne, 8);
+    }
+    return packBitsAVX2(bits + i, n - i, out + i / 8);
+}
+
+#endif
+
+// ---------------------------------------------------------------------------
+// Dispatch
+// ---------------------------------------------------------------------------
+
+static const KernelTable scalarKernels = {
+    CpuLevel::Scalar, findByteScalar, runLengthScalar, histogramScalar, packBitsScalar, unpackBitsTable, crc32cScalar};
+
+#ifdef MLC_X86_KERNELS
+static const KernelTable sse42Kernels = {
+    CpuLevel::SSE42, findByteSSE42, runLengthSSE42, histogramScalar, packBitsSSE42, unpackBitsTable, crc32cSSE42};
+static const KernelTable avx2Kernels = {
+    CpuLevel::AVX2, findByteAVX2, runLengthAVX2, histogramScalar, packBitsAVX2, unpackBitsTable, crc32cSSE42};
+static const KernelTable avx512Kernels = {
+    CpuLevel::AVX512, findByteAVX512, runLengthAVX512, histogramScalar, packBitsAVX512, unpackBitsTable, crc32cSSE42};
+#endif
+
+CpuLevel detectCpuLevel()
+{
+#ifdef MLC_X86_KERNELS
+    __builtin_cpu_init();
+    if (!__builtin_cpu_supports("sse4.2"))
+        return CpuLevel::Scalar;
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw"))
+        return CpuLevel::AVX512;
+    if (__builtin_cpu_supports("avx2"))
+        return CpuLevel::AVX2;
+    return CpuLevel::SSE42;
+#else
+    return CpuLevel::Scalar;
+#endif
+}
+
+const char *cpuLevelName(CpuLevel level)
+{
+    switch (level)
+    {
+    case CpuLevel::SSE42:
+        return "sse42";
+    case CpuLevel::AVX2:
+        return "avx2";
+    case CpuLevel::AVX512:
+        return "avx512";
+    case CpuLevel::Scalar:
+    default:
+        return "scalar";
+    }
+}
+
+const KernelTable &kernelsFor(CpuLevel level)
+{
+    static const CpuLevel detected = detectCpuLevel();
+    if (level > detected)
+        level = detected;
+#ifdef MLC_X86_KERNELS
+    switch (level)
+    {
+    case CpuLevel::AVX512:
+        return avx512Kernels;
+    case CpuLevel::AVX2:
+        return avx2Kernels;
+    case CpuLevel::SSE42:
+        return sse42Kernels;
+    default:
+        break;
+    }
+#endif
+    return scalarKernels;
+}
+
+static CpuLevel selectCpuLevel()
+{
+    CpuLevel level = detectCpuLevel();
+    const char *requested = getenv("MLC_CPU");
+    if (requested)
+    {
+        string name = requested;
+        for (CpuLevel candidate : {CpuLevel::Scalar, CpuLevel::SSE42, CpuLevel::AVX2, CpuLevel::AVX512})
+        {
+            if (name == cpuLevelName(candidate) && candidate < level)
+                level = candidate;
+        }
+    }
+    return level;
+}
+
+const KernelTable &kernels()
+{
+    static const KernelTable &selected = kernelsFor(selectCpuLevel());
+    return selected;
+}
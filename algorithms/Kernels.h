@@ -0,0 +1,49 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+using namespace std;
+
+// Instruction set tiers for the hot loops. One tier is picked at startup
+// from CPUID (capped by MLC_CPU=scalar|sse42|avx2|avx512 if set) so a single
+// binary runs everywhere and uses the widest vectors the host has.
+enum class CpuLevel
+{
+    Scalar,
+    SSE42,
+    AVX2,
+    AVX512
+};
+
+struct KernelTable
+{
+    CpuLevel level;
+
+    // Index of the first byte equal to value, or n if there is none.
+    size_t (*findByte)(const unsigned char *data, size_t n, unsigned char value);
+    // Number of leading bytes equal to value.
+    size_t (*runLength)(const unsigned char *data, size_t n, unsigned char value);
+    // Adds the byte counts of data to counts.
+    void (*histogram)(const unsigned char *data, size_t n, uint64_t counts[256]);
+    // Packs n '0'/'1' characters into bytes, MSB first, zero-padding the last
+    // byte. Returns false if a character is neither '0' nor '1'.
+    bool (*packBits)(const char *bits, size_t n, unsigned char *out);
+    // Expands n bytes into 8 * n '0'/'1' characters, MSB first.
+    void (*unpackBits)(const unsigned char *bytes, size_t n, char *out);
+    // CRC-32C (Castagnoli), continuing from crc.
+    uint32_t (*crc32c)(uint32_t crc, const unsigned char *data, size_t n);
+};
+
+CpuLevel detectCpuLevel();
+const char *cpuLevelName(CpuLevel level);
+
+// Kernels for the given tier, clamped to what the host supports.
+const KernelTable &kernelsFor(CpuLevel level);
+
+// Kernels selected once for this process.
+const KernelTable &kernels();
+
+inline uint32_t crc32c(const unsigned char *data, size_t n)
+{
+    return kernels().crc32c(0xFFFFFFFFu, data, n) ^ 0xFFFFFFFFu;
+}
@@ -1,54 +1,54 @@
 #include "MTF.h"
-#include <list>
+#include "Kernels.h"
 #include <stdexcept>
-#include<algorithm>
+#include <cstring>
 
-string mtfEncode(const string &input)
+// The symbol table is a flat 256-byte array: the lookup is a vector byte
+// search and the move-to-front is a single memmove.
+static void initSymbolTable(unsigned char symbolTable[256])
 {
-    list<unsigned char> symbolTable;
     for (int i = 0; i < 256; ++i)
-        symbolTable.push_back(i);
+        symbolTable[i] = (unsigned char)i;
+}
 
-    string encoded;
-    encoded.reserve(input.size());
+string mtfEncode(const string &input)
+{
+    unsigned char symbolTable[256];
+    initSymbolTable(symbolTable);
+    const KernelTable &k = kernels();
+
+    string encoded(input.size(), '\0');
 
     for (size_t i = 0; i < input.size(); ++i) {
         unsigned char ch = static_cast<unsigned char>(input[i]);
-        auto it = find(symbolTable.begin(), symbolTable.end(), ch);
-        if (it == symbolTable.end())
+        size_t index = k.findByte(symbolTable, 256, ch);
+        if (index == 256)
             throw runtime_error("Character not found in symbol table!");
 
-        int index = distance(symbolTable.begin(), it);
-        encoded += static_cast<unsigned char>(index); // pack index as a byte
+        encoded[i] = static_cast<char>(index); // pack index as a byte
 
         // Move to front
-        symbolTable.erase(it);
-        symbolTable.push_front(ch);
+        memmove(symbolTable + 1, symbolTable, index);
+        symbolTable[0] = ch;
     }
     return encoded;
 }
 
 string mtfDecode(const string &encoded)
 {
-    list<unsigned char> symbolTable;
-    for (int i = 0; i < 256; ++i)
-        symbolTable.push_back(i);
+    unsigned char symbolTable[256];
+    initSymbolTable(symbolTable);
 
-    string decoded;
-    decoded.reserve(encoded.size());
+    string decoded(encoded.size(), '\0');
 
     for (size_t i = 0; i < encoded.size(); ++i) {
         unsigned char idx = static_cast<unsigned char>(encoded[i]);
-        if (idx >= symbolTable.size())
-            throw runtime_error("Invalid index in encoded data!");
-
-        auto it = next(symbolTable.begin(), idx);
-        unsigned char ch = *it;
-        decoded += ch;
+        unsigned char ch = symbolTable[idx];
+        decoded[i] = static_cast<char>(ch);
 
         // Move to front
-        symbolTable.erase(it);
-        symbolTable.push_front(ch);
+        memmove(symbolTable + 1, symbolTable, idx);
+        symbolTable[0] = ch;
     }
     return decoded;
 }
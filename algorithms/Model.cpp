@@ -0,0 +1,108 @@
+#include "Model.h"
+#include "BWT.h"
+#include "MTF.h"
+#include "RLE.h"
+#include <fstream>
+#include <cctype>
+
+TrainedModel trainModel(const string &id, const vector<string> &samples)
+{
+    TrainedModel model;
+    model.id = id;
+    for (int ch = 0; ch < 256; ++ch)
+        model.freqTable[(unsigned char)ch] = 1;
+
+    for (const string &sample : samples)
+    {
+        if (sample.empty())
+            continue;
+        size_t primaryIndex = 0;
+        string rleResult = rleEncoded(mtfEncode(bwtEncode(sample, primaryIndex)));
+        for (unsigned char ch : rleResult)
+            model.freqTable[ch]++;
+    }
+    return model;
+}
+
+bool saveModel(const TrainedModel &model, const string &filename)
+{
+    ofstream outFile(filename);
+    if (!outFile)
+    {
+        cerr << "[Error] Could not open model file for writing.\n";
+        return false;
+    }
+    outFile << "MLCM 1\n" << model.id << '\n' << model.freqTable.size() << '\n';
+    for (const auto &pair : model.freqTable)
+        outFile << (int)pair.first << ' ' << pair.second << '\n';
+    return (bool)outFile;
+}
+
+bool loadModel(const string &filename, TrainedModel &model)
+{
+    ifstream inFile(filename);
+    if (!inFile)
+    {
+        cerr << "[Error] Could not open model file " << filename << ".\n";
+        return false;
+    }
+
+    string magic;
+    int version = 0;
+    size_t n = 0;
+    inFile >> magic >> version >> model.id >> n;
+    if (!inFile || magic != "MLCM" || version != 1 || n == 0 || n > 256 || !isValidModelId(model.id))
+    {
+        cerr << "[Error] Invalid model file " << filename << ".\n";
+        return false;
+    }
+
+    model.freqTable.clear();
+    for (size_t i = 0; i < n; ++i)
+    {
+        int symbol;
+        uint64_t freq;
+        inFile >> symbol >> freq;
+        if (!inFile || symbol < 0 || symbol > 255 || freq == 0)
+        {
+            cerr << "[Error] Invalid model entry in " << filename << ".\n";
+            return false;
+        }
+        model.freqTable[(unsigned char)symbol] = freq;
+    }
+    return true;
+}
+
+bool isValidModelId(const string &id)
+{
+    if (id.empty() || id.size() > 64)
+        return false;
+    for (char c : id)
+    {
+        if (!isalnum((unsigned char)c) && c != '_' && c != '-')
+            return false;
+    }
+    return true;
+}
+
+void ModelRegistry::add(const TrainedModel &model)
+{
+    unique_ptr<HuffmanCoding> coder(new HuffmanCoding());
+    coder->setFrequencyTable(model.freqTable);
+    coders[model.id] = move(coder);
+}
+
+bool ModelRegistry::loadFile(const string &filename)
+{
+    TrainedModel model;
+    if (!loadModel(filename, model))
+        return false;
+    add(model);
+    return true;
+}
+
+const HuffmanCoding *ModelRegistry::find(const string &id) const
+{
+    auto it = coders.find(id);
+    return it == coders.end() ? nullptr : it->second.get();
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include "Huffman.h"
+
+using namespace std;
+
+// A Huffman model trained on a sample corpus and shared between payloads.
+// Payloads compressed with it carry only the model id instead of a
+// frequency table.
+struct TrainedModel
+{
+    string id;
+    FrequencyTable freqTable;
+};
+
+// Runs every sample through BWT -> MTF -> RLE and accumulates the symbol
+// counts the entropy stage would see. Every byte value keeps a non-zero
+// count so inputs outside the corpus remain encodable.
+TrainedModel trainModel(const string &id, const vector<string> &samples);
+
+bool saveModel(const TrainedModel &model, const string &filename);
+bool loadModel(const string &filename, TrainedModel &model);
+
+// Model ids end up in file names, so keep them to [A-Za-z0-9_-].
+bool isValidModelId(const string &id);
+
+// Holds prebuilt Huffman tables keyed by model id. Lookups return coders
+// that are only read from, so one registry can serve many compressions.
+class ModelRegistry
+{
+private:
+    map<string, unique_ptr<HuffmanCoding>> coders;
+
+public:
+    void add(const TrainedModel &model);
+    bool loadFile(const string &filename);
+    const HuffmanCoding *find(const string &id) const;
+};
@@ -0,0 +1,76 @@
+#include "MtfRle.h"
+#include "Kernels.h"
+#include <stdexcept>
+#include <cstring>
+
+void mtfRleEncodeInto(const string &input, string &out, uint64_t counts[256])
+{
+    const unsigned char *data = reinterpret_cast<const unsigned char *>(input.data());
+    size_t n = input.size();
+    const KernelTable &k = kernels();
+
+    unsigned char symbolTable[256];
+    for (int i = 0; i < 256; ++i)
+        symbolTable[i] = (unsigned char)i;
+    memset(counts, 0, 256 * sizeof(uint64_t));
+
+    // Same worst case as rleEncodeInto: one pair per input byte.
+    out.resize(2 * n);
+    char *dst = n ? &out[0] : nullptr;
+    size_t written = 0;
+
+    // The pending run of MTF indices, flushed as a (count, index) pair when
+    // the index changes or the count reaches 255.
+    unsigned char runSymbol = 0;
+    size_t runLength = 0;
+    auto flush = [&]()
+    {
+        dst[written++] = static_cast<char>(runLength);
+        dst[written++] = static_cast<char>(runSymbol);
+        counts[runLength]++;
+        counts[runSymbol]++;
+        runLength = 0;
+    };
+    auto push = [&](unsigned char symbol, size_t count)
+    {
+        if (runLength && symbol != runSymbol)
+            flush();
+        runSymbol = symbol;
+        while (count)
+        {
+            size_t take = count < 255 - runLength ? count : 255 - runLength;
+            runLength += take;
+            count -= take;
+            if (runLength == 255)
+                flush();
+        }
+    };
+
+    for (size_t i = 0; i < n;)
+    {
+        unsigned char ch = data[i];
+        if (symbolTable[0] == ch)
+        {
+            // Repeats of the front symbol are all index 0, and BWT output is
+            // mostly such repeats: skip the whole stretch in one scan.
+            size_t repeat = 1;
+            if (i + 1 < n && data[i + 1] == ch)
+                repeat = k.runLength(data + i, n - i, ch);
+            push(0, repeat);
+            i += repeat;
+            continue;
+        }
+
+        size_t index = k.findByte(symbolTable, 256, ch);
+        if (index == 256)
+            throw runtime_error("Character not found in symbol table!");
+        memmove(symbolTable + 1, symbolTable, index);
+        symbolTable[0] = ch;
+        push(static_cast<unsigned char>(index), 1);
+        ++i;
+    }
+    if (runLength)
+        flush();
+
+    out.resize(written);
+}
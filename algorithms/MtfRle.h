@@ -0,0 +1,11 @@
+#pragma once
+#include <string>
+#include <cstdint>
+
+using namespace std;
+
+// Fused move-to-front + run-length stage. Consumes the BWT output once and
+// writes exactly rleEncoded(mtfEncode(input)) into out, reusing its
+// capacity. counts receives the byte histogram of out, ready to build the
+// entropy coder's model without another pass.
+void mtfRleEncodeInto(const string &input, string &out, uint64_t counts[256]);
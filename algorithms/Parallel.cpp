@@ -0,0 +1,66 @@
+#include "Parallel.h"
+#include <thread>
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <exception>
+
+unsigned defaultThreadCount()
+{
+    unsigned n = thread::hardware_concurrency();
+    return n == 0 ? 1 : n;
+}
+
+void parallelFor(size_t count, unsigned threads, const function<void(size_t, unsigned)> &body)
+{
+    if (count == 0)
+        return;
+    if (threads == 0)
+        threads = defaultThreadCount();
+    if (threads > count)
+        threads = (unsigned)count;
+
+    if (threads == 1)
+    {
+        for (size_t i = 0; i < count; ++i)
+            body(i, 0);
+        return;
+    }
+
+    atomic<size_t> next(0);
+    atomic<bool> failed(false);
+    exception_ptr firstError;
+    mutex errorMutex;
+
+    auto work = [&](unsigned worker)
+    {
+        while (!failed)
+        {
+            size_t i = next++;
+            if (i >= count)
+                break;
+            try
+            {
+                body(i, worker);
+            }
+            catch (...)
+            {
+                lock_guard<mutex> lock(errorMutex);
+                if (!firstError)
+                    firstError = current_exception();
+                failed = true;
+            }
+        }
+    };
+
+    vector<thread> pool;
+    pool.reserve(threads - 1);
+    for (unsigned w = 1; w < threads; ++w)
+        pool.emplace_back(work, w);
+    work(0);
+    for (thread &t : pool)
+        t.join();
+
+    if (firstError)
+        rethrow_exception(firstError);
+}
@@ -0,0 +1,14 @@
+#pragma once
+#include <cstddef>
+#include <functional>
+
+using namespace std;
+
+// Number of workers to use when the caller passes 0.
+unsigned defaultThreadCount();
+
+// Runs body(index, worker) for every index in [0, count) on up to `threads`
+// workers. `worker` is stable per thread so callers can keep one workspace
+// per worker. The first exception thrown by a body is rethrown here after
+// all workers have stopped.
+void parallelFor(size_t count, unsigned threads, const function<void(size_t, unsigned)> &body);
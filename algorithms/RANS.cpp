@@ -0,0 +1,191 @@
+#include "RANS.h"
+#include <stdexcept>
+#include <algorithm>
+#include <cmath>
+#include "Kernels.h"
+
+static string bytesToBits(const vector<unsigned char> &bytes)
+{
+    string bits(bytes.size() * 8, '0');
+    kernels().unpackBits(bytes.data(), bytes.size(), &bits[0]);
+    return bits;
+}
+
+static vector<unsigned char> bitsToBytes(const string &bits)
+{
+    if (bits.size() % 8 != 0)
+        throw runtime_error("Invalid rANS data: bit length must be a multiple of 8.");
+
+    vector<unsigned char> bytes(bits.size() / 8, 0);
+    if (!kernels().packBits(bits.data(), bits.size(), bytes.data()))
+        throw runtime_error("Invalid encoded data.\n");
+    return bytes;
+}
+
+RansCoding::RansCoding() : symbolCount(0)
+{
+    fill(symFreq, symFreq + 256, 0);
+    fill(symCum, symCum + 256, 0);
+}
+
+void RansCoding::buildModel(const string &text)
+{
+    setFrequencyTable(countFrequencies(text));
+}
+
+void RansCoding::setFrequencyTable(const FrequencyTable &table)
+{
+    freqTable = table;
+    normaliseFrequencies();
+}
+
+void RansCoding::normaliseFrequencies()
+{
+    fill(symFreq, symFreq + 256, 0);
+    fill(symCum, symCum + 256, 0);
+    slotToSymbol.assign(RANS_SCALE, 0);
+
+    symbolCount = 0;
+    for (auto pair : freqTable)
+        symbolCount += pair.second;
+    if (symbolCount == 0)
+        return;
+
+    // Scale to RANS_SCALE keeping every present symbol at least 1.
+    uint32_t total = 0;
+    for (auto pair : freqTable)
+    {
+        if (pair.second == 0)
+            continue;
+        uint64_t scaled = (uint64_t)((double)pair.second * RANS_SCALE / symbolCount);
+        symFreq[pair.first] = scaled == 0 ? 1 : (uint32_t)scaled;
+        total += symFreq[pair.first];
+    }
+
+    // Hand the rounding error to (or take it from) the most frequent symbols.
+    while (total != RANS_SCALE)
+    {
+        int best = -1;
+        for (int s = 0; s < 256; ++s)
+        {
+            if (symFreq[s] == 0 || (total > RANS_SCALE && symFreq[s] == 1))
+                continue;
+            if (best < 0 || symFreq[s] > symFreq[best])
+                best = s;
+        }
+        if (total > RANS_SCALE)
+        {
+            symFreq[best]--;
+            total--;
+        }
+        else
+        {
+            symFreq[best]++;
+            total++;
+        }
+    }
+
+    uint32_t cum = 0;
+    for (int s = 0; s < 256; ++s)
+    {
+        symCum[s] = cum;
+        for (uint32_t slot = 0; slot < symFreq[s]; ++slot)
+            slotToSymbol[cum + slot] = (unsigned char)s;
+        cum += symFreq[s];
+    }
+}
+
+string RansCoding::encode(const string &text) const
+{
+    if (text.empty())
+        return "";
+    if (text.size() != symbolCount)
+        throw runtime_error("rANS model does not match input length.");
+
+    // Symbols are pushed in reverse so the decoder can run forwards; bytes
+    // are collected in emission order and reversed at the end.
+    vector<unsigned char> out;
+    out.reserve(text.size() / 2 + 16);
+    uint32_t state[2] = {RANS_LOWER_BOUND, RANS_LOWER_BOUND};
+
+    for (size_t i = text.size(); i-- > 0;)
+    {
+        unsigned char ch = static_cast<unsigned char>(text[i]);
+        uint32_t freq = symFreq[ch];
+        if (freq == 0)
+            throw runtime_error("Symbol not present in rANS table.");
+
+        uint32_t &x = state[i & 1];
+        uint64_t xMax = (uint64_t)((RANS_LOWER_BOUND >> RANS_SCALE_BITS) << 8) * freq;
+        while (x >= xMax)
+        {
+            out.push_back(x & 0xff);
+            x >>= 8;
+        }
+        x = ((x / freq) << RANS_SCALE_BITS) + (x % freq) + symCum[ch];
+    }
+
+    for (int k = 1; k >= 0; --k)
+    {
+        for (int b = 0; b < 4; ++b)
+            out.push_back((state[k] >> (8 * b)) & 0xff);
+    }
+
+    reverse(out.begin(), out.end());
+    return bytesToBits(out);
+}
+
+string RansCoding::decode(const string &encodedStr) const
+{
+    if (encodedStr.empty())
+        return "";
+
+    vector<unsigned char> in = bitsToBytes(encodedStr);
+    if (in.size() < 8)
+        throw runtime_error("Invalid rANS data: stream too short.");
+
+    size_t pos = 0;
+    uint32_t state[2] = {0, 0};
+    for (int k = 0; k < 2; ++k)
+    {
+        for (int b = 0; b < 4; ++b)
+            state[k] = (state[k] << 8) | in[pos++];
+    }
+
+    // symbolCount comes from the untrusted table, so bound it before
+    // allocating: by the largest block any encoder produces, and by what the
+    // stream can hold. A lone symbol costs nothing and its stream is just the
+    // two initial states; otherwise each symbol costs about
+    // log2(RANS_SCALE / maxFreq) bits (1% slack covers the rounding in the
+    // state update).
+    if (symbolCount > MAX_ENTROPY_SYMBOLS)
+        throw runtime_error("Invalid rANS data: symbol count exceeds the block limit.");
+    uint32_t maxFreq = *max_element(symFreq, symFreq + 256);
+    if (maxFreq == RANS_SCALE)
+    {
+        if (in.size() != 8 || state[0] != RANS_LOWER_BOUND || state[1] != RANS_LOWER_BOUND)
+            throw runtime_error("Invalid rANS data: single-symbol stream has extra bytes.");
+        return string(symbolCount, (char)slotToSymbol[0]);
+    }
+    double bitsPerSymbol = log2((double)RANS_SCALE / maxFreq);
+    if (symbolCount > in.size() * 8.0 / bitsPerSymbol * 1.01 + 2)
+        throw runtime_error("Invalid rANS data: symbol count exceeds stream.");
+
+    string decoded(symbolCount, '\0');
+    for (size_t i = 0; i < symbolCount; ++i)
+    {
+        uint32_t &x = state[i & 1];
+        uint32_t slot = x & (RANS_SCALE - 1);
+        unsigned char ch = slotToSymbol[slot];
+        decoded[i] = static_cast<char>(ch);
+
+        x = symFreq[ch] * (x >> RANS_SCALE_BITS) + slot - symCum[ch];
+        while (x < RANS_LOWER_BOUND)
+        {
+            if (pos >= in.size())
+                throw runtime_error("Invalid rANS data: unexpected end of stream.");
+            x = (x << 8) | in[pos++];
+        }
+    }
+    return decoded;
+}
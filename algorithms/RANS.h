@@ -0,0 +1,39 @@
+#pragma once
+#include <string>
+#include <map>
+#include <vector>
+#include <cstdint>
+#include "EntropyCoder.h"
+
+using namespace std;
+
+// Byte-oriented rANS with two interleaved states. Symbol frequencies are
+// normalised to a 2^RANS_SCALE_BITS total so both sides derive the same
+// model from the raw frequency table.
+const int RANS_SCALE_BITS = 12;
+const uint32_t RANS_SCALE = 1u << RANS_SCALE_BITS;
+const uint32_t RANS_LOWER_BOUND = 1u << 23;
+
+class RansCoding : public EntropyCoder
+{
+private:
+    FrequencyTable freqTable;
+    uint32_t symFreq[256];
+    uint32_t symCum[256];
+    vector<unsigned char> slotToSymbol;
+    size_t symbolCount;
+
+    void normaliseFrequencies();
+
+public:
+    RansCoding();
+
+    void buildModel(const string &text) override;
+    string encode(const string &text) const override;
+    string decode(const string &encodedStr) const override;
+
+    FrequencyTable getFrequencyTable() const override { return freqTable; }
+    void setFrequencyTable(const FrequencyTable &table) override;
+
+    const char *name() const override { return "rans"; }
+};
@@ -1,53 +1,88 @@
 #include "RLE.h"
+#include "Kernels.h"
 #include <stdexcept>
-#include <sstream>
+#include <cstring>
 
-string rleEncoded(const string &input)
+void rleEncodeInto(const string &input, string &out)
 {
-    if (input.empty())
-        return "";
+    const unsigned char *data = reinterpret_cast<const unsigned char *>(input.data());
+    size_t n = input.size();
+    const KernelTable &k = kernels();
 
-    string result;
-    unsigned char currentChar = static_cast<unsigned char>(input[0]);
-    unsigned char count = 1;
+    // Worst case is one (count, value) pair per input byte; write pairs
+    // straight into the buffer and trim once at the end.
+    out.resize(2 * n);
+    char *dst = n ? &out[0] : nullptr;
+    size_t written = 0;
 
-    for (size_t i = 1; i < input.size(); ++i)
+    for (size_t i = 0; i < n;)
     {
-        unsigned char ch = static_cast<unsigned char>(input[i]);
-        if (ch == currentChar && count < 255)
-        {
-            count++;
-        }
-        else
-        {
-            result += static_cast<char>(count); 
-            result += static_cast<char>(currentChar);             
-            currentChar = ch;
-            count = 1;
-        }
+        // Runs are capped at 255 so the count fits in one byte. Most runs
+        // after MTF are short, so only hand longer ones to the vector scan.
+        unsigned char currentChar = data[i];
+        size_t limit = n - i < 255 ? n - i : 255;
+        size_t count = 1;
+        if (count < limit && data[i + 1] == currentChar)
+            count = k.runLength(data + i, limit, currentChar);
+
+        dst[written++] = static_cast<char>(count);
+        dst[written++] = static_cast<char>(currentChar);
+        i += count;
     }
-    
-    result += static_cast<char>(count);
-    result += static_cast<char>(currentChar);
 
+    out.resize(written);
+}
+
+string rleEncoded(const string &input)
+{
+    string result;
+    rleEncodeInto(input, result);
     return result;
 }
 
-string rleDecoded(const string &input)
+void rleDecodeInto(const string &input, string &out)
 {
     if (input.size() % 2 != 0)
     {
         throw runtime_error("Invalid RLE data: length must be even.");
     }
 
-    string result;
+    const unsigned char *pairs = reinterpret_cast<const unsigned char *>(input.data());
+    size_t n = input.size();
 
-    for (size_t i = 0; i < input.size(); i += 2)
+    // Size the output up front, then fill each run with one memset.
+    size_t outputSize = 0;
+    for (size_t i = 0; i < n; i += 2)
+        outputSize += pairs[i];
+
+    // Short runs are written as a fixed 16-byte store into slack past the
+    // end, which compiles to one vector store instead of a memset call.
+    const size_t slack = 16;
+    out.resize(outputSize + slack);
+    char *dst = &out[0];
+    for (size_t i = 0; i < n; i += 2)
     {
-        unsigned char count = static_cast<unsigned char>(input[i]);
-        unsigned char ch = static_cast<unsigned char>(input[i + 1]);
-        result.append(count, ch);
+        unsigned char count = pairs[i];
+        if (count <= slack)
+            memset(dst, pairs[i + 1], slack);
+        else
+            memset(dst, pairs[i + 1], count);
+        dst += count;
     }
+    out.resize(outputSize);
+}
 
+uint64_t rleDecodedSize(const string &input)
+{
+    uint64_t size = 0;
+    for (size_t i = 0; i < input.size(); i += 2)
+        size += (unsigned char)input[i];
+    return size;
+}
+
+string rleDecoded(const string &input)
+{
+    string result;
+    rleDecodeInto(input, result);
     return result;
 }
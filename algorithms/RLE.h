@@ -1,6 +1,14 @@
 #pragma once
 #include <string>
+#include <cstdint>
 using namespace std;
 
 string rleEncoded(const string &input);
 string rleDecoded(const string &input);
+
+// Length rleDecoded(input) would return, without decoding.
+uint64_t rleDecodedSize(const string &input);
+
+// Same as above but write into out, reusing its capacity across calls.
+void rleEncodeInto(const string &input, string &out);
+void rleDecodeInto(const string &input, string &out);
@@ -0,0 +1,101 @@
+#include "Archive.h"
+#include <iostream>
+#include <fstream>
+#include <vector>
+using namespace std;
+
+static const char* USAGE =
+    "Usage: archive_cli create <archive.mlca> [--coder=huffman|rans] [--block-size=N] [--threads=N] [--files-from=list] <paths...>\n"
+    "       archive_cli list <archive.mlca>\n"
+    "       archive_cli extract <archive.mlca> [--output-dir=dir] [--threads=N] [names...]\n"
+    "       archive_cli cat <archive.mlca> <name>";
+
+// Multi-file archives: create, list, extract, or print one stored file.
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        cerr << USAGE << endl;
+        return 1;
+    }
+    string command = argv[1], archivePath = argv[2];
+    EntropyBackend backend = EntropyBackend::Huffman;
+    size_t blockSize = DEFAULT_BLOCK_SIZE;
+    unsigned threads = 0;
+    string outputDir = ".";
+    vector<string> names;
+    for (int i = 3; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg.rfind("--coder=", 0) == 0) {
+            if (!parseEntropyBackend(arg.substr(8), backend)) {
+                cerr << "[ERROR] Unknown entropy coder: " << arg.substr(8) << endl;
+                return 1;
+            }
+        } else if (arg.rfind("--block-size=", 0) == 0) {
+            blockSize = stoull(arg.substr(13));
+        } else if (arg.rfind("--threads=", 0) == 0) {
+            threads = (unsigned)stoul(arg.substr(10));
+        } else if (arg.rfind("--output-dir=", 0) == 0) {
+            outputDir = arg.substr(13);
+        } else if (arg.rfind("--files-from=", 0) == 0) {
+            // One path per line, e.g. the output of find.
+            ifstream list(arg.substr(13));
+            if (!list) {
+                cerr << "[ERROR] Could not open " << arg.substr(13) << endl;
+                return 1;
+            }
+            string line;
+            while (getline(list, line))
+                if (!line.empty()) names.push_back(line);
+        } else {
+            names.push_back(arg);
+        }
+    }
+    Compressor compressor(backend);
+
+    try {
+        if (command == "create") {
+            if (names.empty()) {
+                cerr << USAGE << endl;
+                return 1;
+            }
+            ArchiveStats stats = createArchive(archivePath, collectArchiveInputs(names), compressor, blockSize, threads);
+            cerr << "[Info] Archived " << stats.files << " files (" << stats.inputBytes << " bytes) in "
+                 << stats.blocks << " blocks -> " << stats.archiveBytes << " bytes" << endl;
+            return 0;
+        }
+
+        ArchiveReader archive(archivePath);
+        if (command == "list") {
+            for (const ArchiveEntry& entry : archive.entries())
+                cout << entry.size << "\t" << entry.path << "\n";
+            cout.flush();
+            return 0;
+        }
+
+        vector<size_t> selected;
+        for (const string& name : names) {
+            long index = archive.find(name);
+            if (index < 0) {
+                cerr << "[ERROR] Not in archive: " << name << endl;
+                return 1;
+            }
+            selected.push_back((size_t)index);
+        }
+
+        if (command == "extract") {
+            archive.extract(outputDir, compressor, selected, threads);
+            cerr << "[Info] Extracted " << (selected.empty() ? archive.entries().size() : selected.size())
+                 << " files to " << outputDir << endl;
+            return 0;
+        }
+        if (command == "cat" && selected.size() == 1) {
+            string data = archive.read(selected[0], compressor, threads);
+            cout.write(data.data(), data.size());
+            return 0;
+        }
+    } catch (exception& e) {
+        cerr << "[ERROR] " << e.what() << endl;
+        return 1;
+    }
+    cerr << USAGE << endl;
+    return 1;
+}
@@ -0,0 +1,80 @@
+#include "Compressor.h"
+#include "Kernels.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <chrono>
+#include <vector>
+using namespace std;
+
+// Usage: benchmark [--coder=huffman|rans] [--block-size=N] [--iterations=N] <corpus files...>
+// Round-trips every file through the parallel block pipeline and reports
+// throughput.
+// Also drives the profile-guided build (see the pgo_train target).
+int main(int argc, char* argv[]) {
+    EntropyBackend backend = EntropyBackend::Huffman;
+    size_t blockSize = DEFAULT_BLOCK_SIZE;
+    int iterations = 3;
+    vector<string> files;
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg.rfind("--coder=", 0) == 0) {
+            if (!parseEntropyBackend(arg.substr(8), backend)) {
+                cerr << "[ERROR] Unknown entropy coder: " << arg.substr(8) << endl;
+                return 1;
+            }
+        } else if (arg.rfind("--block-size=", 0) == 0) {
+            blockSize = stoull(arg.substr(13));
+        } else if (arg.rfind("--iterations=", 0) == 0) {
+            iterations = stoi(arg.substr(13));
+        } else {
+            files.push_back(arg);
+        }
+    }
+    if (files.empty()) {
+        cerr << "Usage: benchmark [--coder=huffman|rans] [--block-size=N] [--iterations=N] <corpus files...>" << endl;
+        return 1;
+    }
+
+    cout << "[Info] Kernels: " << cpuLevelName(kernels().level) << endl;
+    Compressor compressor(backend);
+    bool ok = true;
+    for (const string& file : files) {
+        ifstream in(file, ios::binary);
+        if (!in) {
+            cerr << "[ERROR] Could not open " << file << endl;
+            return 1;
+        }
+        stringstream buffer;
+        buffer << in.rdbuf();
+        string input = buffer.str();
+
+        double compressSeconds = 0, decompressSeconds = 0;
+        size_t compressedBits = 0;
+        for (int it = 0; it < iterations; ++it) {
+            auto start = chrono::steady_clock::now();
+            vector<CompressedBlock> blocks = compressor.compressBlocks(input, blockSize);
+            auto mid = chrono::steady_clock::now();
+            string output;
+            output.reserve(input.size());
+            compressor.decompressBlocks(blocks, [&](const string& block) { output += block; });
+            auto end = chrono::steady_clock::now();
+
+            compressSeconds += chrono::duration<double>(mid - start).count();
+            decompressSeconds += chrono::duration<double>(end - mid).count();
+            compressedBits = 0;
+            for (const CompressedBlock& block : blocks) compressedBits += block.data.size();
+            if (output != input) {
+                cerr << "[ERROR] Round trip mismatch for " << file << endl;
+                ok = false;
+            }
+        }
+
+        double mb = input.size() * (double)iterations / (1024.0 * 1024.0);
+        cout << file << ": " << input.size() << " bytes -> " << (compressedBits + 7) / 8 << " bytes"
+             << " (ratio " << (compressedBits ? input.size() * 8.0 / compressedBits : 0.0) << ")"
+             << ", compress " << (compressSeconds > 0 ? mb / compressSeconds : 0.0) << " MB/s"
+             << ", decompress " << (decompressSeconds > 0 ? mb / decompressSeconds : 0.0) << " MB/s" << endl;
+    }
+    return ok ? 0 : 1;
+}
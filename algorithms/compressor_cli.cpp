@@ -1,51 +1,130 @@
-#include "Compressor.cpp"
+#include "Compressor.h"
+#include "BlockJson.h"
+#include "Model.h"
 #include <iostream>
 #include <unordered_map>
 #include <map>
-#include <iomanip>
 #include <sstream>
+#include <csignal>
 using namespace std;
 
-string escape_json(const string& s) {
-    ostringstream out;
-    for (unsigned char c : s) {
-        switch (c) {
-            case '"': out << "\\\""; break;
-            case '\\': out << "\\\\"; break;
-            case '\b': out << "\\b"; break;
-            case '\f': out << "\\f"; break;
-            case '\n': out << "\\n"; break;
-            case '\r': out << "\\r"; break;
-            case '\t': out << "\\t"; break;
-            default:
-                if (c < 0x20 || c > 0x7E) {
-                    out << "\\u" << hex << setw(4) << setfill('0') << (int)c;
-                } else {
-                    out << c;
-                }
+// Raised by SIGTERM/SIGINT so a server can cancel a running job and the
+// current block finishes cleanly instead of the process being torn down.
+static atomic<bool> cancelRequested(false);
+
+extern "C" void onCancelSignal(int) {
+    cancelRequested = true;
+}
+
+int main(int argc, char* argv[]) {
+    EntropyBackend backend = EntropyBackend::Huffman;
+    string modelId, modelDir = "models";
+    bool batch = false, blocks = false, estimate = false;
+    size_t blockSize = DEFAULT_BLOCK_SIZE;
+    unsigned threads = 0;
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg.rfind("--coder=", 0) == 0 && !parseEntropyBackend(arg.substr(8), backend)) {
+            cerr << "[ERROR] Unknown entropy coder: " << arg.substr(8) << endl;
+            return 1;
         }
+        if (arg.rfind("--model=", 0) == 0) modelId = arg.substr(8);
+        if (arg.rfind("--model-dir=", 0) == 0) modelDir = arg.substr(12);
+        if (arg == "--batch") batch = true;
+        if (arg == "--blocks") blocks = true;
+        if (arg == "--estimate") estimate = true;
+        if (arg.rfind("--block-size=", 0) == 0) blockSize = stoull(arg.substr(13));
+        if (arg.rfind("--threads=", 0) == 0) threads = (unsigned)stoul(arg.substr(10));
     }
-    return out.str();
-}
+    if (blockSize > MAX_BLOCK_SIZE) {
+        cerr << "[ERROR] Block size is limited to " << MAX_BLOCK_SIZE << " bytes." << endl;
+        return 1;
+    }
+    Compressor compressor(backend);
 
-int main() {
-    Compressor compressor;
-    string input, line;
-    while (getline(cin, line)) {
-        input += line;
-        input += '\n';
+    ModelRegistry models;
+    if (!modelId.empty()) {
+        if (!isValidModelId(modelId) || !models.loadFile(modelDir + "/" + modelId + ".mlcm")) {
+            cerr << "[ERROR] Could not load model: " << modelId << endl;
+            return 1;
+        }
+        compressor.useModel(modelId, models.find(modelId));
     }
-    if (!input.empty() && input.back() == '\n') input.pop_back();
-    string compressed = compressor.compress(input);
-    int primaryIndex = compressor.getPrimaryIndex();
-    auto freqTable = compressor.getHuffman().getFrequencyTable();
-    cout << "{\"compressed\":\"" << escape_json(compressed) << "\",\"primaryIndex\":" << primaryIndex << ",\"freqTable\":{";
-    bool first = true;
-    for (auto& kv : freqTable) {
-        if (!first) cout << ",";
-        cout << "\"" << (int)(unsigned char)kv.first << "\":" << kv.second;
-        first = false;
+
+    if (estimate) {
+        // Predicts what --blocks would produce without compressing.
+        stringstream buffer;
+        buffer << cin.rdbuf();
+        CompressionEstimate e = compressor.estimate(buffer.str(), blockSize, threads);
+        cout << "{\"inputSize\":" << e.inputSize << ",\"samples\":" << e.samples
+             << ",\"sampledBytes\":" << e.sampledBytes << ",\"ratio\":" << e.ratio
+             << ",\"ratioMin\":" << e.ratioMin << ",\"ratioMax\":" << e.ratioMax
+             << ",\"compressedBits\":" << e.compressedBits << ",\"seconds\":" << e.seconds
+             << ",\"secondsMin\":" << e.secondsMin << ",\"secondsMax\":" << e.secondsMax << "}" << endl;
+        return 0;
     }
-    cout << "}}" << endl;
+
+    if (batch) {
+        vector<string> inputs;
+        if (!readBatch(cin, inputs)) {
+            cerr << "[ERROR] Malformed batch input!" << endl;
+            return 1;
+        }
+        vector<CompressedBlock> results;
+        try {
+            results = compressor.compressBatch(inputs, threads);
+        } catch (exception& e) {
+            cerr << "[ERROR] " << e.what() << endl;
+            return 1;
+        }
+        // One JSON line per input, in input order.
+        for (const CompressedBlock& block : results) {
+            writeBlockJson(cout, block);
+            cout << endl;
+        }
+        return 0;
+    }
+
+    if (blocks) {
+        // Block mode keeps the input byte-exact and reports progress on
+        // stderr as "[Progress] <done>/<total>" lines.
+        signal(SIGTERM, onCancelSignal);
+        signal(SIGINT, onCancelSignal);
+        stringstream buffer;
+        buffer << cin.rdbuf();
+        vector<CompressedBlock> result;
+        try {
+            result = compressor.compressBlocks(buffer.str(), blockSize, [](size_t done, size_t total) {
+                cerr << "[Progress] " << done << "/" << total << endl;
+            }, &cancelRequested, threads);
+        } catch (CompressionCancelled&) {
+            cerr << "[Info] Compression cancelled." << endl;
+            return 130;
+        } catch (exception& e) {
+            cerr << "[ERROR] " << e.what() << endl;
+            return 1;
+        }
+        cout << "{\"blockSize\":" << blockSize << ",\"blocks\":[";
+        for (size_t i = 0; i < result.size(); ++i) {
+            if (i) cout << ",";
+            writeBlockJson(cout, result[i]);
+        }
+        cout << "]}" << endl;
+        return 0;
+    }
+
+    // Byte-exact, like --batch and --blocks, so a /compress request gives
+    // the same payload whether or not the server batches it.
+    stringstream buffer;
+    buffer << cin.rdbuf();
+    CompressedBlock block;
+    try {
+        block = compressor.compress(buffer.str());
+    } catch (exception& e) {
+        cerr << "[ERROR] " << e.what() << endl;
+        return 1;
+    }
+    writeBlockJson(cout, block);
+    cout << endl;
     return 0;
-} 
\ No newline at end of file
+}
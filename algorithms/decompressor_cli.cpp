@@ -1,80 +1,72 @@
-#include "Compressor.cpp"
+#include "Compressor.h"
+#include "BlockJson.h"
+#include "Model.h"
 #include <iostream>
 #include <sstream>
 #include <map>
+#include <vector>
 using namespace std;
 
-int main() {
+int main(int argc, char* argv[]) {
+    string modelDir = "models";
+    bool lowMemory = false;
+    unsigned threads = 0;
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg.rfind("--model-dir=", 0) == 0) modelDir = arg.substr(12);
+        else if (arg == "--low-memory") lowMemory = true;
+        else if (arg.rfind("--threads=", 0) == 0) threads = (unsigned)stoul(arg.substr(10));
+    }
     Compressor compressor;
+    compressor.setLowMemory(lowMemory);
     string input, line;
     while (getline(cin, line)) {
         input += line;
     }
-    // Debug: print the raw input
-    cerr << "[DEBUG] Raw input: " << input << endl;
 
-    size_t compressedStart = input.find("\"compressed\":\"");
-    if (compressedStart == string::npos) {
-        cerr << "[ERROR] Could not find compressed data in input!" << endl;
-        return 1;
-    }
-    compressedStart += 14;
-    size_t compressedEnd = input.find("\"", compressedStart);
-    if (compressedEnd == string::npos) {
-        cerr << "[ERROR] Could not find end of compressed data!" << endl;
-        return 1;
+    vector<string> objects;
+    if (input.find("\"blocks\":[") != string::npos) {
+        if (!splitBlocks(input, objects)) {
+            cerr << "[ERROR] Malformed blocks array in input!" << endl;
+            return 1;
+        }
+    } else {
+        objects.push_back(input);
     }
-    string compressed = input.substr(compressedStart, compressedEnd - compressedStart);
 
-    size_t indexStart = input.find("\"primaryIndex\":");
-    if (indexStart == string::npos) {
-        cerr << "[ERROR] Could not find primaryIndex in input!" << endl;
-        return 1;
+    vector<CompressedBlock> blocks(objects.size());
+    for (size_t i = 0; i < objects.size(); ++i) {
+        if (!parseBlock(objects[i], blocks[i])) return 1;
     }
-    indexStart += 15;
-    size_t indexEnd = input.find(",", indexStart);
-    if (indexEnd == string::npos) indexEnd = input.find("}", indexStart);
-    int primaryIndex = stoi(input.substr(indexStart, indexEnd - indexStart));
+    // Only the parsed blocks are needed from here on.
+    string().swap(input);
+    vector<string>().swap(objects);
 
-    size_t freqStart = input.find("\"freqTable\":{");
-    if (freqStart == string::npos) {
-        cerr << "[ERROR] Could not find freqTable in input!" << endl;
-        return 1;
-    }
-    freqStart += 12;
-    size_t freqEnd = input.find("}", freqStart);
-    if (freqEnd == string::npos) {
-        cerr << "[ERROR] Could not find end of freqTable!" << endl;
-        return 1;
-    }
-    string freqStr = input.substr(freqStart, freqEnd - freqStart);
-
-    map<unsigned char, int> freqTable;
-    stringstream ss(freqStr);
-    string pair;
-    while (getline(ss, pair, ',')) {
-        size_t colon = pair.find(':');
-        if (colon != string::npos) {
-            size_t quote = pair.find('"');
-            if (quote == string::npos || quote+1 >= pair.size()) continue;
-            int key = stoi(pair.substr(quote+1, colon-quote-1));
-            int value = stoi(pair.substr(colon+1));
-            freqTable[static_cast<unsigned char>(key)] = value;
+    // The compressor holds one shared model, and compressor_cli never mixes
+    // models within a payload, so reject payloads that do.
+    ModelRegistry models;
+    for (const CompressedBlock& block : blocks) {
+        if (block.modelId.empty() || block.modelId == compressor.getModelId()) continue;
+        if (compressor.hasModel()) {
+            cerr << "[ERROR] Blocks use more than one model: " << compressor.getModelId()
+                 << ", " << block.modelId << endl;
+            return 1;
+        }
+        if (!models.loadFile(modelDir + "/" + block.modelId + ".mlcm")) {
+            cerr << "[ERROR] Could not load model: " << block.modelId << endl;
+            return 1;
         }
+        compressor.useModel(block.modelId, models.find(block.modelId));
     }
 
-    // Debug output
-    cerr << "[DEBUG] Compressed: " << compressed << endl;
-    cerr << "[DEBUG] Compressed length: " << compressed.length() << endl;
-    cerr << "[DEBUG] Primary Index: " << primaryIndex << endl;
-    cerr << "[DEBUG] Frequency Table:" << endl;
-    for (auto& kv : freqTable) {
-        cerr << "  '" << kv.first << "': " << kv.second << endl;
+    // Blocks decode in parallel and are written as soon as every earlier
+    // block has been, so output starts before the last block is done.
+    try {
+        compressor.decompressBlocks(blocks, [](const string& output) { cout << output; }, threads);
+    } catch (exception& e) {
+        cerr << "[ERROR] " << e.what() << endl;
+        return 1;
     }
-
-    compressor.getHuffman().setFrequencyTable(freqTable);
-
-    string decompressed = compressor.decompress(compressed, primaryIndex);
-    cout << decompressed << endl;
+    cout << endl;
     return 0;
-} 
\ No newline at end of file
+}
@@ -0,0 +1,101 @@
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size);
+
+// Driver for builds without libFuzzer (GCC, afl-g++). Arguments are input
+// files or directories of them; with no arguments one input is read from
+// stdin, which is what AFL expects. --random=N instead runs N seeded random
+// inputs: mutations of the given files if there are any, otherwise fresh
+// strings mixing small alphabets (long runs) and arbitrary bytes.
+
+static void runInput(const string &input)
+{
+    LLVMFuzzerTestOneInput(reinterpret_cast<const uint8_t *>(input.data()), input.size());
+}
+
+static string readFile(const filesystem::path &path)
+{
+    ifstream in(path, ios::binary);
+    return string((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+}
+
+static string randomInput(mt19937 &gen, unsigned long round)
+{
+    uniform_int_distribution<int> lengthDis(0, 300), byteDis(0, 255), alphabetDis(1, 4);
+    string input(lengthDis(gen), '\0');
+    int alphabet = round % 2 ? 256 : alphabetDis(gen);
+    for (char &c : input)
+        c = (char)(byteDis(gen) % alphabet);
+    return input;
+}
+
+// A few byte overwrites, insertions and deletions; digits are favoured so
+// numeric fields in text formats change value rather than just break.
+static string mutate(string input, mt19937 &gen)
+{
+    uniform_int_distribution<int> editsDis(1, 4), kindDis(0, 2), byteDis(0, 255), digitDis('0', '9');
+    for (int edits = editsDis(gen); edits > 0; --edits)
+    {
+        size_t pos = input.empty() ? 0 : gen() % (input.size() + 1);
+        char value = (char)(gen() % 2 ? digitDis(gen) : byteDis(gen));
+        int kind = kindDis(gen);
+        if (kind == 0 && pos < input.size())
+            input[pos] = value;
+        else if (kind == 1)
+            input.insert(input.begin() + pos, value);
+        else if (pos < input.size())
+            input.erase(pos, 1);
+    }
+    return input;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2)
+    {
+        string input((istreambuf_iterator<char>(cin)), istreambuf_iterator<char>());
+        runInput(input);
+        return 0;
+    }
+
+    unsigned long randomRuns = 0;
+    vector<string> inputs;
+    for (int i = 1; i < argc; ++i)
+    {
+        string arg = argv[i];
+        if (arg.rfind("--random=", 0) == 0)
+        {
+            randomRuns = strtoul(arg.c_str() + 9, nullptr, 10);
+        }
+        else if (filesystem::is_directory(arg))
+        {
+            for (const auto &entry : filesystem::directory_iterator(arg))
+                if (entry.is_regular_file())
+                    inputs.push_back(readFile(entry.path()));
+        }
+        else
+        {
+            inputs.push_back(readFile(arg));
+        }
+    }
+
+    for (const string &input : inputs)
+        runInput(input);
+
+    mt19937 gen(20240601);
+    for (unsigned long r = 0; r < randomRuns; ++r)
+        runInput(inputs.empty() ? randomInput(gen, r) : mutate(inputs[r % inputs.size()], gen));
+    return 0;
+}
@@ -0,0 +1,138 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstring>
+#include "BWT.h"
+#include "MTF.h"
+#include "RLE.h"
+#include "MtfRle.h"
+#include "Kernels.h"
+#include "Compressor.h"
+
+using namespace std;
+
+// Straightforward reference versions of every stage, written for clarity
+// rather than speed. The differential checks below compare the optimized
+// code against them; shared by fuzz_roundtrip and test_roundtrip.
+
+inline string referenceBwtEncode(const string &input)
+{
+    size_t n = input.size();
+    vector<string> rotations;
+    for (size_t i = 0; i < n; ++i)
+        rotations.push_back(input.substr(i) + input.substr(0, i));
+    sort(rotations.begin(), rotations.end(), [](const string &a, const string &b)
+         { return lexicographical_compare(a.begin(), a.end(), b.begin(), b.end(),
+                                          [](char x, char y) { return (unsigned char)x < (unsigned char)y; }); });
+    string bwt;
+    for (const string &r : rotations)
+        bwt += r[n - 1];
+    return bwt;
+}
+
+inline string referenceMtfEncode(const string &input)
+{
+    vector<unsigned char> table;
+    for (int i = 0; i < 256; ++i)
+        table.push_back((unsigned char)i);
+    string out;
+    for (unsigned char ch : input)
+    {
+        size_t index = find(table.begin(), table.end(), ch) - table.begin();
+        out += (char)index;
+        table.erase(table.begin() + index);
+        table.insert(table.begin(), ch);
+    }
+    return out;
+}
+
+inline string referenceRleEncode(const string &input)
+{
+    string out;
+    for (size_t i = 0; i < input.size();)
+    {
+        size_t count = 1;
+        while (i + count < input.size() && input[i + count] == input[i] && count < 255)
+            count++;
+        out += (char)count;
+        out += input[i];
+        i += count;
+    }
+    return out;
+}
+
+inline string referenceRleDecode(const string &input)
+{
+    string out;
+    for (size_t i = 0; i + 1 < input.size(); i += 2)
+        out.append((unsigned char)input[i], input[i + 1]);
+    return out;
+}
+
+// Runs input through every stage and kernel tier and returns a description
+// of the first disagreement, or an empty string if everything matches.
+// Inputs are expected to be small: the reference BWT is quadratic.
+inline string checkRoundTrip(const string &input)
+{
+    size_t primaryIndex = 0;
+    string bwt = bwtEncode(input, primaryIndex);
+    if (bwt != referenceBwtEncode(input))
+        return "bwtEncode differs from reference";
+    if (bwtDecode(bwt, primaryIndex) != input)
+        return "bwtDecode does not invert bwtEncode";
+    if (bwtDecodeLowMemory(bwt, primaryIndex) != input)
+        return "bwtDecodeLowMemory does not invert bwtEncode";
+
+    string mtf = mtfEncode(input);
+    if (mtf != referenceMtfEncode(input))
+        return "mtfEncode differs from reference";
+    if (mtfDecode(mtf) != input)
+        return "mtfDecode does not invert mtfEncode";
+
+    string rle = rleEncoded(input);
+    if (rle != referenceRleEncode(input))
+        return "rleEncoded differs from reference";
+    if (rleDecoded(rle) != input || referenceRleDecode(rle) != input)
+        return "rleDecoded does not invert rleEncoded";
+
+    string fused;
+    uint64_t counts[256];
+    mtfRleEncodeInto(input, fused, counts);
+    if (fused != referenceRleEncode(referenceMtfEncode(input)))
+        return "mtfRleEncodeInto differs from reference";
+
+    const unsigned char *data = reinterpret_cast<const unsigned char *>(input.data());
+    size_t n = input.size();
+    const KernelTable &ref = kernelsFor(CpuLevel::Scalar);
+    for (CpuLevel level : {CpuLevel::SSE42, CpuLevel::AVX2, CpuLevel::AVX512})
+    {
+        const KernelTable &k = kernelsFor(level);
+        string name = cpuLevelName(k.level);
+        unsigned char value = n ? data[n / 2] : 0;
+        if (k.findByte(data, n, value) != ref.findByte(data, n, value))
+            return name + " findByte differs from scalar";
+        if (k.runLength(data, n, value) != ref.runLength(data, n, value))
+            return name + " runLength differs from scalar";
+        uint64_t a[256] = {}, b[256] = {};
+        k.histogram(data, n, a);
+        ref.histogram(data, n, b);
+        if (memcmp(a, b, sizeof(a)) != 0)
+            return name + " histogram differs from scalar";
+        if (k.crc32c(0xFFFFFFFFu, data, n) != ref.crc32c(0xFFFFFFFFu, data, n))
+            return name + " crc32c differs from scalar";
+    }
+
+    for (EntropyBackend backend : {EntropyBackend::Huffman, EntropyBackend::RANS})
+    {
+        Compressor compressor(backend);
+        CompressedBlock block = compressor.compressBlock(input);
+        Compressor decompressor;
+        if (decompressor.decompressBlock(block) != input)
+            return string(entropyBackendName(backend)) + " pipeline round trip failed";
+        decompressor.setLowMemory(true);
+        if (decompressor.decompressBlock(block) != input)
+            return string(entropyBackendName(backend)) + " low-memory pipeline round trip failed";
+    }
+    return "";
+}
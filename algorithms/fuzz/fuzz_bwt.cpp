@@ -0,0 +1,52 @@
+#include "BWT.h"
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+// Input: 4-byte little-endian primary index, then the BWT string. The index
+// is taken modulo n+1 so the out-of-range case is reached too. Both inverse
+// transforms must reject the same inputs; on genuine transforms (those the
+// forward BWT reproduces) they must also return the same text.
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    if (size < 4 || size > 4096 + 4)
+        return 0;
+    uint32_t raw;
+    memcpy(&raw, data, 4);
+    string bwt(reinterpret_cast<const char *>(data + 4), size - 4);
+    size_t primaryIndex = raw % (bwt.size() + 1);
+
+    string fast, small;
+    bool fastOk = true, smallOk = true;
+    try
+    {
+        fast = bwtDecode(bwt, primaryIndex);
+    }
+    catch (runtime_error &)
+    {
+        fastOk = false;
+    }
+    try
+    {
+        small = bwtDecodeLowMemory(bwt, primaryIndex);
+    }
+    catch (runtime_error &)
+    {
+        smallOk = false;
+    }
+    if (fastOk != smallOk)
+        abort();
+    if (!fastOk)
+        return 0;
+    if (fast.size() != bwt.size() || small.size() != bwt.size())
+        abort();
+
+    size_t reencodedIndex = 0;
+    if (bwtEncode(fast, reencodedIndex) == bwt && reencodedIndex == primaryIndex && small != fast)
+        abort();
+    return 0;
+}
@@ -0,0 +1,45 @@
+#include "BlockJson.h"
+#include "Compressor.h"
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// Whole decompressor_cli input: container parsing, then decoding every
+// block that parsed. Any outcome other than success or an exception is a
+// bug.
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    static bool quiet = (cerr.setstate(ios::failbit), true);
+    (void)quiet;
+
+    string input(reinterpret_cast<const char *>(data), size);
+    vector<string> objects;
+    if (input.find("\"blocks\":[") != string::npos)
+    {
+        if (!splitBlocks(input, objects))
+            return 0;
+    }
+    else
+    {
+        objects.push_back(input);
+    }
+
+    for (const string &object : objects)
+    {
+        CompressedBlock block;
+        if (!parseBlock(object, block))
+            continue;
+        try
+        {
+            Compressor compressor;
+            compressor.decompressBlock(block);
+        }
+        catch (exception &)
+        {
+        }
+    }
+    return 0;
+}
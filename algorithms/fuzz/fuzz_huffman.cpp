@@ -0,0 +1,43 @@
+#include "Huffman.h"
+#include <cstdint>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+// Input: symbol count k, then k (symbol, frequency) byte pairs forming the
+// table, then one bit per remaining byte ('0'/'1', with 0xFF standing in for
+// an invalid character). Decoding complete codes and re-encoding them must
+// reproduce a prefix of the bit string.
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    if (size < 1)
+        return 0;
+    size_t k = data[0];
+    if (size < 1 + 2 * k)
+        return 0;
+    FrequencyTable table;
+    for (size_t i = 0; i < k; ++i)
+        table[data[1 + 2 * i]] += data[2 + 2 * i];
+
+    string bits;
+    for (size_t i = 1 + 2 * k; i < size; ++i)
+        bits += data[i] == 0xFF ? 'x' : (data[i] & 1 ? '1' : '0');
+
+    HuffmanCoding coder;
+    coder.setFrequencyTable(table);
+    string decoded;
+    try
+    {
+        decoded = coder.decode(bits);
+    }
+    catch (runtime_error &)
+    {
+        return 0;
+    }
+    string reencoded = coder.encode(decoded);
+    if (bits.compare(0, reencoded.size(), reencoded) != 0)
+        abort();
+    return 0;
+}
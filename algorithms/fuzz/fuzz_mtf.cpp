@@ -0,0 +1,19 @@
+#include "MTF.h"
+#include "fuzz/RoundTrip.h"
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+
+using namespace std;
+
+// MTF is a bijection on byte strings: any input decodes, and encoding the
+// result must give the input back.
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    string encoded(reinterpret_cast<const char *>(data), size);
+    string decoded = mtfDecode(encoded);
+    if (decoded.size() != encoded.size() || mtfEncode(decoded) != encoded ||
+        referenceMtfEncode(decoded) != encoded)
+        abort();
+    return 0;
+}
@@ -0,0 +1,29 @@
+#include "RLE.h"
+#include "fuzz/RoundTrip.h"
+#include <cstdint>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+// Arbitrary (count, value) streams: odd lengths must be rejected, everything
+// else must match the reference decoder and survive a re-encode.
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    string pairs(reinterpret_cast<const char *>(data), size);
+    string decoded;
+    try
+    {
+        decoded = rleDecoded(pairs);
+    }
+    catch (runtime_error &)
+    {
+        if (size % 2 == 0)
+            abort();
+        return 0;
+    }
+    if (size % 2 != 0 || decoded != referenceRleDecode(pairs) || rleDecoded(rleEncoded(decoded)) != decoded)
+        abort();
+    return 0;
+}
@@ -0,0 +1,22 @@
+#include "fuzz/RoundTrip.h"
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+using namespace std;
+
+// Differential round trip: every stage against its reference and every
+// kernel tier against scalar. Capped at 2 KiB for the quadratic references.
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    if (size > 2048)
+        return 0;
+    string failure = checkRoundTrip(string(reinterpret_cast<const char *>(data), size));
+    if (!failure.empty())
+    {
+        fprintf(stderr, "%s\n", failure.c_str());
+        abort();
+    }
+    return 0;
+}
@@ -0,0 +1,51 @@
+#include "Model.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+using namespace std;
+
+// Usage: model_trainer_cli [--lines] <model-id> <output.mlcm> <sample files...>
+// Each file is one sample, or with --lines each non-empty line is one sample
+// (e.g. one JSON body per line).
+int main(int argc, char* argv[]) {
+    vector<string> args;
+    bool perLine = false;
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "--lines") perLine = true;
+        else args.push_back(arg);
+    }
+    if (args.size() < 3) {
+        cerr << "Usage: model_trainer_cli [--lines] <model-id> <output.mlcm> <sample files...>" << endl;
+        return 1;
+    }
+    if (!isValidModelId(args[0])) {
+        cerr << "[ERROR] Model id must match [A-Za-z0-9_-]{1,64}" << endl;
+        return 1;
+    }
+
+    vector<string> samples;
+    for (size_t i = 2; i < args.size(); ++i) {
+        ifstream in(args[i], ios::binary);
+        if (!in) {
+            cerr << "[ERROR] Could not open sample: " << args[i] << endl;
+            return 1;
+        }
+        if (perLine) {
+            string line;
+            while (getline(in, line)) {
+                if (!line.empty()) samples.push_back(line);
+            }
+        } else {
+            stringstream buffer;
+            buffer << in.rdbuf();
+            samples.push_back(buffer.str());
+        }
+    }
+
+    TrainedModel model = trainModel(args[0], samples);
+    if (!saveModel(model, args[1])) return 1;
+    cerr << "[Info] Trained model '" << model.id << "' from " << samples.size() << " samples -> " << args[1] << endl;
+    return 0;
+}
@@ -0,0 +1,148 @@
+#include "Archive.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <filesystem>
+#include <random>
+#include <map>
+
+using namespace std;
+
+static int failures = 0;
+
+void check(bool ok, const string &desc)
+{
+    if (!ok)
+    {
+        failures++;
+        cout << "Failed: " << desc << endl;
+    }
+}
+
+void writeFile(const filesystem::path &path, const string &data)
+{
+    filesystem::create_directories(path.parent_path());
+    ofstream out(path, ios::binary);
+    out.write(data.data(), data.size());
+}
+
+string readFile(const filesystem::path &path)
+{
+    ifstream in(path, ios::binary);
+    stringstream buffer;
+    buffer << in.rdbuf();
+    return buffer.str();
+}
+
+template <typename F>
+bool throws(F f)
+{
+    try
+    {
+        f();
+    }
+    catch (runtime_error &)
+    {
+        return true;
+    }
+    return false;
+}
+
+int main()
+{
+    filesystem::path root = filesystem::temp_directory_path() / ("mlc_test_archive_" + to_string(random_device()()));
+    mt19937 gen(7);
+
+    // Many small files that share blocks, one that spans several, an empty
+    // one, and binary content.
+    map<string, string> files;
+    for (int i = 0; i < 40; ++i)
+        files["src/small/file" + to_string(i) + ".txt"] = "small file " + to_string(i) + " banana bandana\n";
+    string large;
+    for (int i = 0; i < 3000; ++i)
+        large += "line " + to_string(i % 97) + " of a larger file\n";
+    files["src/large.txt"] = large;
+    files["src/empty"] = "";
+    string binary(5000, '\0');
+    for (char &c : binary)
+        c = (char)(gen() & 0xff);
+    files["src/nested/deep/binary.bin"] = binary;
+    for (const auto &f : files)
+        writeFile(root / f.first, f.second);
+
+    for (EntropyBackend backend : {EntropyBackend::Huffman, EntropyBackend::RANS})
+    {
+        cout << "[Test] Archive with " << (backend == EntropyBackend::RANS ? "rans" : "huffman") << endl;
+        Compressor compressor(backend);
+        string archivePath = (root / "test.mlca").string();
+        vector<ArchiveInput> inputs = collectArchiveInputs({(root / "src").string()});
+        check(inputs.size() == files.size(), "collect finds every file");
+        // Names keep the temp directory path, minus its root.
+        string prefix = inputs[0].name.substr(0, inputs[0].name.find("src/"));
+
+        ArchiveStats stats = createArchive(archivePath, inputs, compressor, 4096, 3);
+        check(stats.files == files.size(), "stats count files");
+        check(stats.blocks < files.size(), "small files share blocks");
+        check(stats.archiveBytes == filesystem::file_size(archivePath), "stats archive size");
+
+        ArchiveReader archive(archivePath);
+        check(archive.blockCount() == stats.blocks, "reader block count");
+        check(archive.entries().size() == files.size(), "listing has every file");
+        for (const ArchiveEntry &entry : archive.entries())
+        {
+            auto it = files.find(entry.path.substr(prefix.size()));
+            check(it != files.end() && it->second.size() == entry.size, "listed size of " + entry.path);
+        }
+
+        // Single-file reads decode only what they overlap.
+        for (const ArchiveInput &input : inputs)
+        {
+            long index = archive.find(input.name);
+            check(index >= 0, "find " + input.name);
+            if (index >= 0)
+                check(archive.read(index, compressor, 2) == readFile(input.source), "read " + input.name);
+        }
+        check(archive.find("missing") == -1, "find missing");
+
+        filesystem::path out = root / "out";
+        archive.extract(out.string(), compressor, {}, 2);
+        for (const ArchiveInput &input : inputs)
+            check(readFile(out / input.name) == readFile(input.source) && filesystem::exists(out / input.name),
+                  "extract " + input.name);
+
+        filesystem::path one = root / "one";
+        long large = archive.find(prefix + "src/large.txt");
+        archive.extract(one.string(), compressor, {(size_t)large});
+        check(readFile(one / prefix / "src/large.txt") == files["src/large.txt"], "selective extract writes the file");
+        check(!filesystem::exists(one / prefix / "src/empty"), "selective extract writes nothing else");
+        filesystem::remove_all(out);
+        filesystem::remove_all(one);
+    }
+
+    cout << "[Test] Corrupt and unsafe archives" << endl;
+    Compressor compressor;
+    string archivePath = (root / "test.mlca").string();
+    string bytes = readFile(archivePath);
+    string truncated = bytes.substr(0, bytes.size() - 3);
+    writeFile(root / "bad.mlca", truncated);
+    check(throws([&] { ArchiveReader reader((root / "bad.mlca").string()); }), "truncated archive throws");
+    string flipped = bytes;
+    flipped[flipped.size() - 21] ^= 0x40;
+    writeFile(root / "bad.mlca", flipped);
+    check(throws([&] { ArchiveReader reader((root / "bad.mlca").string()); }), "corrupt directory throws");
+    check(throws([&] { ArchiveReader reader((root / "missing.mlca").string()); }), "missing archive throws");
+
+    string empty = (root / "src/empty").string();
+    createArchive((root / "evil.mlca").string(), {{"fine.txt", empty}, {"../evil.txt", empty}}, compressor);
+    ArchiveReader evil((root / "evil.mlca").string());
+    check(throws([&] { evil.extract((root / "out").string(), compressor); }), "unsafe path rejected");
+    check(!filesystem::exists(root / "evil.txt"), "unsafe path not written");
+    check(!filesystem::exists(root / "out" / "fine.txt"), "nothing written before an unsafe path");
+
+    check(throws([&] { createArchive((root / "dup.mlca").string(), {{"a/x", empty}, {"a/x", empty}}, compressor); }),
+          "duplicate names rejected");
+
+    filesystem::remove_all(root);
+    cout << (failures == 0 ? "All tests passed." : "Some tests failed.") << endl;
+    return failures == 0 ? 0 : 1;
+}
@@ -6,19 +6,28 @@
 
 using namespace std;
 
+static int failures = 0;
+
 void testBWT(const string &input, const string &desc)
 {
     cout << "[Test] " << desc << endl;
 
-    int primaryIndex = 0;
+    size_t primaryIndex = 0;
     string encoded = bwtEncode(input, primaryIndex);
     string decoded = bwtDecode(encoded, primaryIndex);
+    string lowMemoryDecoded = bwtDecodeLowMemory(encoded, primaryIndex);
 
     cout << "Original: " << input << endl;
     cout << "Encoded:  " << encoded << endl;
     cout << "Decoded:  " << decoded << endl;
     cout << "Primary Index: " << primaryIndex << endl;
 
+    if (lowMemoryDecoded != decoded)
+    {
+        cout << "Failed: low-memory decode differs\n";
+        failures++;
+    }
+
     if (decoded == input)
     {
         cout << "Passed\n\n";
@@ -26,6 +35,7 @@ void testBWT(const string &input, const string &desc)
     else
     {
         cout << "Failed\n";
+        failures++;
         cout << "Expected: " << input << endl;
         cout << "Got:      " << decoded << endl
              << endl;
@@ -70,6 +80,11 @@ int main()
     // Unicode test 
     testBWT("😀😁😂🤣😃😄😅😆😉😊", "Unicode emoji test (UTF-8)");
 
+    // Long enough that the low-memory decoder counts forward across its
+    // 4096-row occurrence checkpoints, including inside a long run.
+    testBWT(randomString(5000) + string(3000, 'x'), "Random text with a long run (8000 chars)");
+    testBWT(randomString(9000) + string(4000, 'y') + randomString(7000), "Several occurrence checkpoints (20000 chars)");
+
     cout << "All tests completed." << endl;
-    return 0;
+    return failures == 0 ? 0 : 1;
 }
@@ -2,13 +2,23 @@
 #include "MTF.h"
 #include "RLE.h"
 #include "Huffman.h"
+#include "Compressor.h"
+#include "RANS.h"
+#include "Model.h"
+#include "BlockJson.h"
 #include <iostream>
 #include <vector>
 #include <string>
+#include <sstream>
+#include <chrono>
+#include <random>
+#include <cstdio>
 
 using namespace std;
 
-string compressPipeline(const string &input, int &primaryIndex)
+static int failures = 0;
+
+string compressPipeline(const string &input, size_t &primaryIndex, FrequencyTable &freqTable)
 {
     // Step 1: BWT
     string bwtResult = bwtEncode(input, primaryIndex);
@@ -26,15 +36,17 @@ string compressPipeline(const string &input, int &primaryIndex)
     HuffmanCoding huffman;
     huffman.buildHuffmanTree(rleResult);
     string huffmanResult = huffman.encode(rleResult);
+    freqTable = huffman.getFrequencyTable();
     cout << "[Huffman] Output size: " << huffmanResult.size() << endl;
 
     return huffmanResult;
 }
 
-string decompressPipeline(const string &compressed, int primaryIndex)
+string decompressPipeline(const string &compressed, size_t primaryIndex, const FrequencyTable &freqTable)
 {
     // Step 1: Huffman Decode
     HuffmanCoding huffman;
+    huffman.setFrequencyTable(freqTable);
     string rleResult = huffman.decode(compressed);
     cout << "[Huffman Decode] Size: " << rleResult.size() << endl;
 
@@ -80,11 +92,12 @@ void runTests()
             cout << "Input: [Large string of size " << test.size() << "]" << endl;
         }
 
-        int primaryIndex = 0;
-        string compressed = compressPipeline(test, primaryIndex);
+        size_t primaryIndex = 0;
+        FrequencyTable freqTable;
+        string compressed = compressPipeline(test, primaryIndex, freqTable);
         cout << "[Info] Compression complete. Primary Index: " << primaryIndex << endl;
 
-        string decompressed = decompressPipeline(compressed, primaryIndex);
+        string decompressed = decompressPipeline(compressed, primaryIndex, freqTable);
         cout << "[Info] Decompression complete." << endl;
 
         if (decompressed == test)
@@ -93,15 +106,319 @@ void runTests()
         }
         else
         {
+            failures++;
             cout << "Test failed: decompressed string does not match original." << endl;
         }
     }
 }
 
+// Parallel block decompression must deliver blocks in order whatever the
+// thread count or reorder window, and surface a corrupt block as an error.
+void testParallelBlocks()
+{
+    string input;
+    for (int i = 0; i < 400; ++i)
+        input += "block " + to_string(i * 7919 % 1000) + " of the parallel test; ";
+
+    Compressor compressor;
+    vector<CompressedBlock> blocks = compressor.compressBlocks(input, 256);
+    for (unsigned threads : {1u, 2u, 8u})
+    {
+        for (size_t window : {(size_t)1, (size_t)3, (size_t)0})
+        {
+            string output;
+            size_t calls = 0;
+            compressor.decompressBlocks(blocks, [&](const string &block)
+                                        { output += block; calls++; }, threads, window);
+            if (output != input || calls != blocks.size())
+            {
+                failures++;
+                cout << "Test failed: parallel decompression with " << threads << " threads, window " << window << endl;
+            }
+        }
+    }
+
+    blocks[blocks.size() / 2].checksum ^= 1;
+    bool threw = false;
+    try
+    {
+        compressor.decompressBlocks(blocks, [](const string &) {}, 4, 2);
+    }
+    catch (runtime_error &)
+    {
+        threw = true;
+    }
+    if (!threw)
+    {
+        failures++;
+        cout << "Test failed: corrupt block was not reported." << endl;
+    }
+    cout << "Parallel block decompression tests completed." << endl;
+}
+
+// The estimate should land near the real ratio of compressBlocks().
+void testEstimate()
+{
+    string input;
+    for (int i = 0; i < 3000; ++i)
+        input += "record " + to_string(i * 7919 % 1013) + " status=" + (i % 3 ? "ok" : "retry") + "\n";
+
+    for (EntropyBackend backend : {EntropyBackend::Huffman, EntropyBackend::RANS})
+    {
+        Compressor compressor(backend);
+        CompressionEstimate estimate = compressor.estimate(input, 16 * 1024);
+        auto start = chrono::steady_clock::now();
+        size_t bits = 0;
+        for (const CompressedBlock &block : compressor.compressBlocks(input, 16 * 1024))
+            bits += block.data.size();
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        double actual = input.size() * 8.0 / bits;
+        cout << "[Estimate] " << entropyBackendName(backend) << ": predicted " << estimate.ratio
+             << " (" << estimate.ratioMin << "-" << estimate.ratioMax << "), actual " << actual
+             << "; predicted time " << estimate.seconds << "s (" << estimate.secondsMin << "-"
+             << estimate.secondsMax << "), actual " << seconds << "s" << endl;
+        if (estimate.samples == 0 || estimate.ratio < actual * 0.75 || estimate.ratio > actual * 1.25)
+        {
+            failures++;
+            cout << "Test failed: estimate too far from actual ratio." << endl;
+        }
+        // Timings on a shared machine are noisy, so allow twice the range.
+        if (estimate.secondsMin <= 0 || estimate.secondsMin > estimate.seconds || estimate.seconds > estimate.secondsMax ||
+            seconds < estimate.secondsMin / 2 || seconds > estimate.secondsMax * 2)
+        {
+            failures++;
+            cout << "Test failed: estimated time range does not cover the actual time." << endl;
+        }
+    }
+
+    if (Compressor().estimate("").samples != 0)
+    {
+        failures++;
+        cout << "Test failed: empty input should not be sampled." << endl;
+    }
+
+    // One repeated byte sorts in about n^2 log n: the probes must stay
+    // cheap, and the prediction must reflect the cost rather than n log n.
+    string repeated(2000000, 'a'), noise(2000000, '\0');
+    mt19937 gen(11);
+    for (char &c : noise)
+        c = (char)(gen() & 0xff);
+    auto start = chrono::steady_clock::now();
+    CompressionEstimate slow = Compressor().estimate(repeated, DEFAULT_BLOCK_SIZE, 1);
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    CompressionEstimate fast = Compressor().estimate(noise, DEFAULT_BLOCK_SIZE, 1);
+    cout << "[Estimate] repeated byte: predicted time " << slow.seconds << "s in " << seconds << "s; random "
+         << fast.seconds << "s" << endl;
+    if (seconds > 3 || slow.seconds < fast.seconds * 100)
+    {
+        failures++;
+        cout << "Test failed: estimate on repetitive input is slow or misses its cost." << endl;
+    }
+}
+
+// A context reused for an empty input must not keep the previous table.
+void testEmptyAfterInput()
+{
+    for (EntropyBackend backend : {EntropyBackend::Huffman, EntropyBackend::RANS})
+    {
+        Compressor compressor(backend);
+        stringstream errors;
+        streambuf *saved = cerr.rdbuf(errors.rdbuf());
+        vector<CompressedBlock> blocks = compressor.compressBatch({"abc", ""}, 1);
+        cerr.rdbuf(saved);
+        if (blocks.size() != 2 || blocks[0].freqTable.empty() || !blocks[1].freqTable.empty() ||
+            !blocks[1].data.empty() || !errors.str().empty() || compressor.decompressBlock(blocks[1]) != "")
+        {
+            failures++;
+            cout << "Test failed: empty input after \"abc\" with " << entropyBackendName(backend) << endl;
+        }
+    }
+}
+
+// The rANS decoder must reject a table claiming more symbols than its
+// stream can encode, without allocating them, and still accept the most
+// skewed tables the encoder produces.
+void testRansSymbolBound()
+{
+    RansCoding rans;
+    string skewed = string(1000000, 'a') + "b";
+    rans.buildModel(skewed);
+    bool ok = rans.decode(rans.encode(skewed)) == skewed;
+
+    rans.buildModel(string(100000, 'a'));
+    ok = ok && rans.decode(rans.encode(string(100000, 'a'))) == string(100000, 'a');
+
+    // A single-symbol stream is always the two initial states, so only the
+    // block limit bounds its count.
+    string initialStates;
+    for (int k = 0; k < 2; ++k)
+        initialStates += "00000000" "10000000" "00000000" "00000000";
+    vector<FrequencyTable> hostile = {{{0, 400000000}, {1, 1}}, {{5, 20000000000ull}}, {{5, MAX_ENTROPY_SYMBOLS + 1}}};
+    for (const FrequencyTable &table : hostile)
+    {
+        rans.setFrequencyTable(table);
+        for (const string &data : {string(150 * 8, '0'), initialStates})
+        {
+            try
+            {
+                rans.decode(data);
+                ok = false;
+            }
+            catch (runtime_error &)
+            {
+            }
+        }
+    }
+    rans.setFrequencyTable({{5, 1000}});
+    ok = ok && rans.decode(initialStates) == string(1000, 5);
+    if (!ok)
+    {
+        failures++;
+        cout << "Test failed: rANS symbol count bound." << endl;
+    }
+}
+
+// Train, save and reload a shared model, then round-trip through it.
+void testModels()
+{
+    vector<string> samples = {"status=ok id=17\n", "status=retry id=4\n", "status=ok id=905\n"};
+    TrainedModel model = trainModel("logs-v1", samples);
+    bool ok = model.id == "logs-v1" && model.freqTable.size() == 256;
+
+    string path = "test_compressor_model.mlcm";
+    TrainedModel loaded;
+    ok = ok && saveModel(model, path) && loadModel(path, loaded) && loaded.id == model.id &&
+         loaded.freqTable == model.freqTable;
+    ok = ok && isValidModelId("logs-v1") && !isValidModelId("../logs") && !isValidModelId("");
+
+    ModelRegistry registry;
+    ok = ok && registry.loadFile(path) && registry.find("logs-v1") && !registry.find("other");
+    remove(path.c_str());
+
+    Compressor compressor;
+    compressor.useModel("logs-v1", registry.find("logs-v1"));
+    string input = "status=ok id=1234\nstatus=retry id=99\n";
+    CompressedBlock block = compressor.compressBlock(input);
+    ok = ok && block.modelId == "logs-v1" && block.freqTable.empty();
+    ok = ok && compressor.decompressBlock(block) == input;
+
+    // Blocks that need a model fail cleanly without it.
+    for (bool other : {false, true})
+    {
+        Compressor plain;
+        TrainedModel otherModel = trainModel("other", samples);
+        registry.add(otherModel);
+        if (other)
+            plain.useModel("other", registry.find("other"));
+        try
+        {
+            plain.decompressBlock(block);
+            ok = false;
+        }
+        catch (runtime_error &e)
+        {
+            ok = ok && string(e.what()).find("not loaded") != string::npos;
+        }
+    }
+
+    if (!ok)
+    {
+        failures++;
+        cout << "Test failed: shared model training, storage or round trip." << endl;
+    }
+}
+
+// compressBlocks() reports every block once, ending at total/total, and
+// stops with CompressionCancelled once the cancel flag is raised.
+void testProgressAndCancel()
+{
+    string input;
+    for (int i = 0; i < 200; ++i)
+        input += "progress line " + to_string(i) + "\n";
+    Compressor compressor;
+    for (unsigned threads : {1u, 4u})
+    {
+        size_t calls = 0, lastDone = 0, lastTotal = 0;
+        bool ordered = true;
+        vector<CompressedBlock> blocks = compressor.compressBlocks(input, 256, [&](size_t done, size_t total)
+                                                                   {
+                                                                       ordered = ordered && done == lastDone + 1;
+                                                                       calls++;
+                                                                       lastDone = done;
+                                                                       lastTotal = total;
+                                                                   },
+                                                                   nullptr, threads);
+        if (calls != blocks.size() || lastDone != blocks.size() || lastTotal != blocks.size() || !ordered)
+        {
+            failures++;
+            cout << "Test failed: progress with " << threads << " threads." << endl;
+        }
+
+        atomic<bool> cancel(false);
+        size_t reported = 0;
+        bool cancelled = false;
+        try
+        {
+            compressor.compressBlocks(input, 256, [&](size_t, size_t)
+                                      {
+                                          reported++;
+                                          cancel = true;
+                                      },
+                                      &cancel, threads);
+        }
+        catch (CompressionCancelled &)
+        {
+            cancelled = true;
+        }
+        if (!cancelled || reported >= blocks.size())
+        {
+            failures++;
+            cout << "Test failed: cancellation with " << threads << " threads." << endl;
+        }
+    }
+}
+
+// Batch framing keeps every input byte-exact, and compressBatch() returns
+// results in input order.
+void testBatch()
+{
+    vector<string> frames;
+    stringstream framed(string("3\nabc\n0\n\n6\na\nb\r\n\n2\n") + string("\0\xff", 2));
+    bool ok = readBatch(framed, frames) && frames.size() == 4 && frames[0] == "abc" && frames[1].empty() &&
+              frames[2] == "a\nb\r\n\n" && frames[3] == string("\0\xff", 2);
+    for (const char *bad : {"x\nabc", "-1\n", "10\nabc", "3 \nabc"})
+    {
+        vector<string> ignored;
+        stringstream in(bad);
+        ok = ok && !readBatch(in, ignored);
+    }
+
+    for (unsigned threads : {1u, 3u})
+    {
+        Compressor compressor;
+        vector<CompressedBlock> blocks = compressor.compressBatch(frames, threads);
+        ok = ok && blocks.size() == frames.size();
+        for (size_t i = 0; ok && i < frames.size(); ++i)
+            ok = compressor.decompressBlock(blocks[i]) == frames[i];
+    }
+    if (!ok)
+    {
+        failures++;
+        cout << "Test failed: batch framing or compressBatch." << endl;
+    }
+}
+
 int main()
 {
     cout << "Starting advanced pipeline tests..." << endl;
     runTests();
+    testParallelBlocks();
+    testEstimate();
+    testEmptyAfterInput();
+    testRansSymbolBound();
+    testModels();
+    testProgressAndCancel();
+    testBatch();
     cout << "All tests completed." << endl;
-    return 0;
+    return failures == 0 ? 0 : 1;
 }
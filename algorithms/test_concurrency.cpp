@@ -0,0 +1,112 @@
+#include "Compressor.h"
+#include "Huffman.h"
+#include <iostream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+using namespace std;
+
+static int failures = 0;
+
+void check(bool ok, const string &desc)
+{
+    if (!ok)
+    {
+        failures++;
+        cout << "Failed: " << desc << endl;
+    }
+}
+
+string makeInput(unsigned thread, int round)
+{
+    string input;
+    for (int i = 0; i < 40 + round; ++i)
+        input += "thread " + to_string(thread) + " round " + to_string(round) + " item " + to_string(i * 31 % 17) + "; ";
+    return input;
+}
+
+// One const Compressor per backend shared by many threads at once, through
+// both the per-thread default context and caller-owned contexts.
+void testSharedCompressor()
+{
+    const unsigned threadCount = 8;
+    const int rounds = 30;
+    for (EntropyBackend backend : {EntropyBackend::Huffman, EntropyBackend::RANS})
+    {
+        const Compressor compressor(backend);
+        atomic<int> mismatches(0);
+        vector<thread> threads;
+        for (unsigned t = 0; t < threadCount; ++t)
+        {
+            threads.emplace_back([&, t]()
+                                 {
+                                     CompressionContext context;
+                                     for (int round = 0; round < rounds; ++round)
+                                     {
+                                         string input = makeInput(t, round);
+                                         CompressedBlock block = round % 2 ? compressor.compressBlock(input)
+                                                                           : compressor.compressBlock(input, context);
+                                         string output = round % 3 ? compressor.decompressBlock(block)
+                                                                   : compressor.decompressBlock(block, context);
+                                         if (output != input)
+                                             mismatches++;
+                                     }
+                                 });
+        }
+        for (thread &t : threads)
+            t.join();
+        check(mismatches == 0, string("shared ") + entropyBackendName(backend) + " compressor round trips");
+    }
+}
+
+// Blocks from one thread must decode on another: nothing about a block may
+// live in the compressing thread's context.
+void testCrossThreadBlocks()
+{
+    const Compressor compressor;
+    string input = makeInput(99, 5);
+    CompressedBlock block;
+    thread([&]()
+           { block = compressor.compressBlock(input); })
+        .join();
+    string output;
+    thread([&]()
+           { output = compressor.decompressBlock(block); })
+        .join();
+    check(output == input, "block compressed and decompressed on different threads");
+}
+
+void testHuffmanCopies()
+{
+    string text = "abracadabra alakazam";
+    HuffmanCoding original;
+    original.buildHuffmanTree(text);
+    string encoded = original.encode(text);
+
+    HuffmanCoding copy(original);
+    HuffmanCoding assigned;
+    assigned.buildHuffmanTree("zzzz");
+    assigned = original;
+
+    // Rebuilding or destroying the original must not touch the copies.
+    original.buildHuffmanTree("something else entirely");
+    check(copy.decode(encoded) == text, "copy-constructed Huffman coder decodes");
+    check(assigned.decode(encoded) == text, "assigned Huffman coder decodes");
+
+    HuffmanCoding *temporary = new HuffmanCoding(copy);
+    delete temporary;
+    check(copy.decode(encoded) == text, "copy survives destruction of its own copy");
+
+    assigned = assigned;
+    check(assigned.decode(encoded) == text, "self-assignment keeps the tree");
+}
+
+int main()
+{
+    testSharedCompressor();
+    testCrossThreadBlocks();
+    testHuffmanCopies();
+    cout << (failures == 0 ? "All tests passed." : "Some tests failed.") << endl;
+    return failures == 0 ? 0 : 1;
+}
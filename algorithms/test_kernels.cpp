@@ -0,0 +1,85 @@
+#include "Kernels.h"
+#include <iostream>
+#include <string>
+#include <vector>
+#include <random>
+#include <cstring>
+
+using namespace std;
+
+static int failures = 0;
+
+void check(bool ok, const string &desc)
+{
+    if (!ok)
+    {
+        failures++;
+        cout << "Failed: " << desc << endl;
+    }
+}
+
+// Every tier must agree with the scalar kernels on every length, including
+// the tails that fall back to narrower code.
+void testTier(CpuLevel level, mt19937 &gen)
+{
+    const KernelTable &ref = kernelsFor(CpuLevel::Scalar);
+    const KernelTable &k = kernelsFor(level);
+    string name = cpuLevelName(k.level);
+    cout << "[Test] Tier " << name << endl;
+
+    uniform_int_distribution<int> byteDis(0, 255);
+    for (size_t n = 0; n < 300; ++n)
+    {
+        vector<unsigned char> data(n);
+        for (auto &b : data)
+            b = (unsigned char)byteDis(gen) % 4; // small alphabet gives long runs
+
+        unsigned char value = n ? data[n / 2] : 0;
+        check(k.findByte(data.data(), n, value) == ref.findByte(data.data(), n, value), name + " findByte n=" + to_string(n));
+        check(k.findByte(data.data(), n, 200) == n, name + " findByte absent n=" + to_string(n));
+
+        vector<unsigned char> run(n, 7);
+        if (n > 3)
+            run[n - 3] = 8;
+        check(k.runLength(run.data(), n, 7) == ref.runLength(run.data(), n, 7), name + " runLength n=" + to_string(n));
+        check(k.runLength(data.data(), n, value) == ref.runLength(data.data(), n, value), name + " runLength random n=" + to_string(n));
+
+        uint64_t a[256] = {}, b[256] = {};
+        k.histogram(data.data(), n, a);
+        ref.histogram(data.data(), n, b);
+        check(memcmp(a, b, sizeof(a)) == 0, name + " histogram n=" + to_string(n));
+
+        string bits(n, '0');
+        for (auto &c : bits)
+            c = byteDis(gen) & 1 ? '1' : '0';
+        vector<unsigned char> packedA((n + 7) / 8 + 1, 0xAA), packedB((n + 7) / 8 + 1, 0xAA);
+        check(k.packBits(bits.data(), n, packedA.data()) && ref.packBits(bits.data(), n, packedB.data()) && packedA == packedB,
+              name + " packBits n=" + to_string(n));
+        string unpacked(((n + 7) / 8) * 8, 'x');
+        k.unpackBits(packedA.data(), (n + 7) / 8, &unpacked[0]);
+        check(unpacked.compare(0, n, bits) == 0, name + " unpackBits n=" + to_string(n));
+        if (n > 0)
+        {
+            bits[n - 1] = '2';
+            check(!k.packBits(bits.data(), n, packedA.data()), name + " packBits rejects n=" + to_string(n));
+        }
+
+        check(k.crc32c(0xFFFFFFFFu, data.data(), n) == ref.crc32c(0xFFFFFFFFu, data.data(), n), name + " crc32c n=" + to_string(n));
+    }
+}
+
+int main()
+{
+    mt19937 gen(12345);
+    cout << "Detected tier: " << cpuLevelName(detectCpuLevel()) << endl;
+
+    // Known CRC-32C check value.
+    const char *digits = "123456789";
+    check(crc32c(reinterpret_cast<const unsigned char *>(digits), 9) == 0xE3069283u, "crc32c check value");
+
+    for (CpuLevel level : {CpuLevel::Scalar, CpuLevel::SSE42, CpuLevel::AVX2, CpuLevel::AVX512})
+        testTier(level, gen);
+
+    cout << (failures == 0 ? "All tests passed." : "Some tests failed.") << endl;
+    return failures == 0 ? 0 : 1;
+}
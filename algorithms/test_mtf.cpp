@@ -5,10 +5,12 @@
 
 using namespace std;
 
+static int failures = 0;
+
 void testMTF(const string &input, const string &desc)
 {
     cout << "[Test] " << desc << endl;
-    vector<int> encoded = mtfEncode(input);
+    string encoded = mtfEncode(input);
     string decoded = mtfDecode(encoded);
 
     if (decoded == input)
@@ -18,6 +20,7 @@ void testMTF(const string &input, const string &desc)
     else
     {
         cout << "Failed\n";
+        failures++;
         cout << "Expected: " << input << "\nGot:      " << decoded << endl;
     }
 }
@@ -33,5 +36,5 @@ int main()
     testMTF("😀😂😅😉", "UTF-8 Emoji test (if supported)");
 
     cout << "All tests completed." << endl;
-    return 0;
+    return failures == 0 ? 0 : 1;
 }
@@ -0,0 +1,62 @@
+#include "MtfRle.h"
+#include "MTF.h"
+#include "RLE.h"
+#include "BWT.h"
+#include <iostream>
+#include <string>
+#include <random>
+#include <cstring>
+using namespace std;
+
+static int failures = 0;
+
+// The fused stage must be byte-identical to the separate passes, and its
+// histogram must match a plain count of that output.
+void test(const string &input, const string &desc, string &buffer)
+{
+    uint64_t counts[256];
+    mtfRleEncodeInto(input, buffer, counts);
+    string expected = rleEncoded(mtfEncode(input));
+
+    uint64_t expectedCounts[256] = {};
+    for (unsigned char c : expected)
+        expectedCounts[c]++;
+
+    if (buffer != expected || memcmp(counts, expectedCounts, sizeof(counts)) != 0)
+    {
+        failures++;
+        cout << "Test failed: " << desc << endl;
+    }
+    else
+    {
+        cout << "Test passed: " << desc << endl;
+    }
+}
+
+int main()
+{
+    // One buffer for every case, so stale contents would show up.
+    string buffer;
+    test("", "empty", buffer);
+    test("a", "single byte", buffer);
+    test(string(1000, '\0'), "long run of the initial front symbol", buffer);
+    test(string(255, 'a') + string(256, 'b') + string(17, 'c'), "runs at the 255 cap", buffer);
+    test(string(600, 'z') + "abababab", "long run then alternation", buffer);
+
+    string text = "banana bandana cabana banana bandana cabana";
+    size_t primaryIndex;
+    test(bwtEncode(text, primaryIndex), "BWT output", buffer);
+
+    mt19937 gen(42);
+    uniform_int_distribution<int> alphabet(0, 3), length(0, 40), byteDis(0, 255);
+    for (int round = 0; round < 200; ++round)
+    {
+        string input;
+        while (input.size() < 2000)
+            input.append(length(gen), (char)(round % 2 ? byteDis(gen) : 'a' + alphabet(gen)));
+        test(input, "random runs " + to_string(round), buffer);
+    }
+
+    cout << (failures == 0 ? "All tests passed." : "Some tests failed.") << endl;
+    return failures == 0 ? 0 : 1;
+}
@@ -2,6 +2,8 @@
 #include <iostream>
 using namespace std;
 
+static int failures = 0;
+
 void test(const string &input, const string &desc)
 {
     string encoded = rleEncoded(input);
@@ -22,6 +24,7 @@ void test(const string &input, const string &desc)
     }
     else
     {
+        failures++;
         cout << "Test failed: decoded string does not match original.\n"
              << endl;
     }
@@ -37,6 +40,8 @@ int main()
     test("a1b2c3d4", "Testing mixed symbols...");
     const char rawData[] = {0x00, 0x00, 0x00, 'a', 'b', 'c'};
     test(string(rawData, sizeof(rawData)), "Testing binary data...");
+    test(string(255, 'a') + string(256, 'b') + string(17, 'c'), "Testing runs at the 255 cap...");
+    test(string(1000, '\0'), "Testing long run of zero bytes...");
 
-    return 0;
+    return failures == 0 ? 0 : 1;
 }
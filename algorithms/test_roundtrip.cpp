@@ -0,0 +1,58 @@
+#include "fuzz/RoundTrip.h"
+#include <iostream>
+#include <string>
+#include <random>
+using namespace std;
+
+static int failures = 0;
+
+void check(const string &input, const string &desc)
+{
+    string failure = checkRoundTrip(input);
+    if (!failure.empty())
+    {
+        failures++;
+        cout << "Failed: " << desc << ": " << failure << endl;
+    }
+}
+
+int main()
+{
+    // Adversarial shapes: degenerate alphabets, runs straddling the RLE
+    // cap, periodic inputs with tied rotations and every byte value.
+    check("", "empty");
+    check("a", "single byte");
+    check("\x01", "single byte coding to a single RLE symbol");
+    check(string(1, '\0'), "single NUL");
+    check(string(255, 'a'), "run of 255");
+    check(string(256, 'a'), "run of 256");
+    check(string(511, '\xFF'), "run of 511 high bytes");
+    check(string(1000, '\0'), "long NUL run");
+    string periodic;
+    for (int i = 0; i < 300; ++i)
+        periodic += "ab";
+    check(periodic, "periodic input");
+    string allBytes;
+    for (int i = 0; i < 256; ++i)
+        allBytes += (char)i;
+    check(allBytes, "every byte value");
+    check(string(allBytes.rbegin(), allBytes.rend()), "every byte value reversed");
+    string ramp;
+    for (int i = 0; i < 256; ++i)
+        ramp.append(i % 17 + 1, (char)(255 - i));
+    check(ramp, "runs of varying length over all bytes");
+
+    mt19937 gen(7);
+    uniform_int_distribution<int> lengthDis(0, 600), byteDis(0, 255), alphabetDis(1, 8);
+    for (int round = 0; round < 300; ++round)
+    {
+        int alphabet = round % 3 == 0 ? 256 : alphabetDis(gen);
+        string input(lengthDis(gen), '\0');
+        for (char &c : input)
+            c = (char)(byteDis(gen) % alphabet);
+        check(input, "random input " + to_string(round));
+    }
+
+    cout << (failures == 0 ? "All tests passed." : "Some tests failed.") << endl;
+    return failures == 0 ? 0 : 1;
+}
@@ -1,4 +1,5 @@
-#include "Compressor.cpp"
+#include "Compressor.h"
+#include "BlockJson.h"
 #include <iostream>
 #include <string>
 #include <sstream>
@@ -11,24 +12,20 @@ int main() {
     
     // Check if input is JSON (decompression) or plain text (compression)
     if (input.find("\"compressed\":") != string::npos) {
-        // Decompression mode
-        size_t compressedStart = input.find("\"compressed\":\"") + 14;
-        size_t compressedEnd = input.find("\"", compressedStart);
-        string compressed = input.substr(compressedStart, compressedEnd - compressedStart);
-        
-        size_t indexStart = input.find("\"primaryIndex\":") + 15;
-        size_t indexEnd = input.find("}", indexStart);
-        int primaryIndex = stoi(input.substr(indexStart, indexEnd - indexStart));
-        
-        string decompressed = compressor.decompress(compressed, primaryIndex);
-        cout << decompressed << endl;
+        // Decompression mode: the block JSON printed by compression mode
+        CompressedBlock block;
+        if (!parseBlock(input, block)) return 1;
+        try {
+            cout << compressor.decompress(block) << endl;
+        } catch (exception& e) {
+            cerr << "[ERROR] " << e.what() << endl;
+            return 1;
+        }
     } else {
         // Compression mode
-        string compressed = compressor.compress(input);
-        int primaryIndex = compressor.getPrimaryIndex();
-        
-        // Output JSON format
-        cout << "{\"compressed\":\"" << compressed << "\",\"primaryIndex\":" << primaryIndex << "}" << endl;
+        CompressedBlock block = compressor.compress(input);
+        writeBlockJson(cout, block);
+        cout << endl;
     }
     
     return 0;
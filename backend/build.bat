@@ -1,12 +1,13 @@
 @echo off
 echo Building C++ executables...
 
-REM Compile compressor_cli
-echo Compiling compressor_cli...
-g++ -std=c++17 -o compressor_cli.exe ../algorithms/compressor_cli.cpp ../algorithms/Compressor.cpp ../algorithms/BWT.cpp ../algorithms/MTF.cpp ../algorithms/RLE.cpp ../algorithms/Huffman.cpp
+REM Optimized (-O3 + LTO) release build of libmlc and the CLIs
+cmake -S .. -B ../build -G "MinGW Makefiles" -DCMAKE_BUILD_TYPE=Release || exit /b 1
+cmake --build ../build || exit /b 1
 
-REM Compile decompressor_cli  
-echo Compiling decompressor_cli...
-g++ -std=c++17 -o decompressor_cli.exe ../algorithms/decompressor_cli.cpp ../algorithms/Compressor.cpp ../algorithms/BWT.cpp ../algorithms/MTF.cpp ../algorithms/RLE.cpp ../algorithms/Huffman.cpp
+echo Copying executables to backend...
+copy /Y ..\build\algorithms\compressor_cli.exe . >nul
+copy /Y ..\build\algorithms\decompressor_cli.exe . >nul
+copy /Y ..\build\algorithms\model_trainer_cli.exe . >nul
 
-echo Build completed successfully! 
\ No newline at end of file
+echo Build completed successfully!
@@ -1,22 +1,17 @@
 #!/bin/bash
+set -e
 
 # Build script for Render deployment
 echo "Building C++ executables..."
 
-# Navigate to algorithms directory
-cd algorithms
-
-# Compile compressor_cli
-echo "Compiling compressor_cli..."
-g++ -std=c++17 -o compressor_cli compressor_cli.cpp Compressor.cpp BWT.cpp MTF.cpp RLE.cpp Huffman.cpp
-
-# Compile decompressor_cli  
-echo "Compiling decompressor_cli..."
-g++ -std=c++17 -o decompressor_cli decompressor_cli.cpp Compressor.cpp BWT.cpp MTF.cpp RLE.cpp Huffman.cpp
+# Optimized (-O3 + LTO) release build of libmlc and the CLIs
+cmake -S . -B build -DCMAKE_BUILD_TYPE=Release
+cmake --build build -j"$(nproc 2>/dev/null || echo 2)"
 
 # Copy executables to backend directory
 echo "Copying executables to backend..."
-cp compressor_cli ../backend/
-cp decompressor_cli ../backend/
+cp build/algorithms/compressor_cli backend/
+cp build/algorithms/decompressor_cli backend/
+cp build/algorithms/model_trainer_cli backend/
 
-echo "Build completed successfully!" 
\ No newline at end of file
+echo "Build completed successfully!"
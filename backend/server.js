@@ -3,6 +3,7 @@ const cors = require('cors');
 const { spawn } = require('child_process');
 const multer = require('multer');
 const path = require('path');
+const crypto = require('crypto');
 
 const app = express();
 const PORT = process.env.PORT || 5000;
@@ -12,20 +13,115 @@ app.use(express.json());
 
 // Test endpoint
 app.get('/test', (req, res) => {
-    res.json({ message: 'API is working!', endpoints: ['POST /compress', 'POST /decompress', 'POST /upload'] });
+    res.json({ message: 'API is working!', endpoints: ['POST /compress', 'POST /decompress', 'POST /upload', 'POST /estimate', 'POST /jobs', 'GET /jobs/:id', 'GET /jobs/:id/result', 'DELETE /jobs/:id'] });
 });
 
+const ENTROPY_CODERS = ['huffman', 'rans'];
+
+// Trained shared models (<id>.mlcm) produced by model_trainer_cli
+const MODEL_DIR = process.env.MLC_MODEL_DIR || path.join(__dirname, 'models');
+const MODEL_ID_PATTERN = /^[A-Za-z0-9_-]{1,64}$/;
+
+// Set MLC_LOW_MEMORY=1 on small nodes to decompress with the bounded-memory inverse BWT
+const DECOMPRESS_ARGS = process.env.MLC_LOW_MEMORY === '1' ? ['--low-memory'] : [];
+
+// Extra CLI arguments for the optional entropy coder selection
+function coderArgs(coder) {
+    return coder ? [`--coder=${coder}`] : [];
+}
+
+// Extra CLI arguments for compressing against a shared model
+function modelArgs(model) {
+    return model ? [`--model=${model}`, `--model-dir=${MODEL_DIR}`] : [];
+}
+
 // File upload configuration
 const storage = multer.memoryStorage();
 const upload = multer({ storage: storage });
 
+// Micro-batching: concurrent /compress requests with the same options are
+// coalesced into one `compressor_cli --batch` run, which compresses them on
+// a thread pool. MLC_BATCH_WINDOW_MS=0 disables batching.
+const BATCH_WINDOW_MS = parseInt(process.env.MLC_BATCH_WINDOW_MS || '5', 10);
+const BATCH_MAX = parseInt(process.env.MLC_BATCH_MAX || '64', 10);
+const pendingBatches = new Map(); // CLI args -> { items, timer }
+
+function flushBatch(key) {
+    const batch = pendingBatches.get(key);
+    if (!batch) return;
+    pendingBatches.delete(key);
+    clearTimeout(batch.timer);
+
+    const exeName = process.platform === 'win32' ? 'compressor_cli.exe' : './compressor_cli';
+    const compressor = spawn(exeName, ['--batch', ...batch.args], { cwd: __dirname });
+
+    let output = '';
+    let error = '';
+
+    compressor.stdout.on('data', (data) => { output += data.toString(); });
+    compressor.stderr.on('data', (data) => { error += data.toString(); });
+
+    compressor.on('close', (code) => {
+        const lines = output.trim().split('\n');
+        batch.items.forEach((item, i) => {
+            if (code !== 0 || lines.length !== batch.items.length) {
+                return item.reject(new Error(error || 'Compression failed'));
+            }
+            try {
+                item.resolve(JSON.parse(lines[i]));
+            } catch (e) {
+                item.reject(new Error('Invalid output from compressor'));
+            }
+        });
+    });
+
+    for (const item of batch.items) {
+        compressor.stdin.write(`${Buffer.byteLength(item.text, 'utf8')}\n`);
+        compressor.stdin.write(item.text);
+    }
+    compressor.stdin.end();
+}
+
+function compressBatched(text, args) {
+    return new Promise((resolve, reject) => {
+        const key = args.join(' ');
+        let batch = pendingBatches.get(key);
+        if (!batch) {
+            batch = { args, items: [], timer: setTimeout(() => flushBatch(key), BATCH_WINDOW_MS) };
+            pendingBatches.set(key, batch);
+        }
+        batch.items.push({ text, resolve, reject });
+        if (batch.items.length >= BATCH_MAX) flushBatch(key);
+    });
+}
+
 // Compression endpoint
 app.post('/compress', (req, res) => {
-    const { text } = req.body;
+    const { text, coder, model } = req.body;
     if (!text) return res.status(400).json({ error: 'No text provided' });
+    if (coder && !ENTROPY_CODERS.includes(coder)) {
+        return res.status(400).json({ error: `Unknown coder, expected one of: ${ENTROPY_CODERS.join(', ')}` });
+    }
+    if (model && !MODEL_ID_PATTERN.test(model)) {
+        return res.status(400).json({ error: 'Invalid model id' });
+    }
+
+    const args = [...coderArgs(coder), ...modelArgs(model)];
+    const respond = (result) => res.json({
+        ...result,
+        timestamp: new Date().toISOString(),
+        originalSize: text.length,
+        compressedSize: result.compressed.length
+    });
+
+    if (BATCH_WINDOW_MS > 0) {
+        return compressBatched(text, args)
+            .then(respond)
+            .catch((e) => res.status(500).json({ error: e.message }));
+    }
 
     const exeName = process.platform === 'win32' ? 'compressor_cli.exe' : './compressor_cli';
-    const compressor = spawn(exeName, [], { cwd: __dirname });
+    const compressor = spawn(exeName, args, { cwd: __dirname });
 
     let output = '';
     let error = '';
@@ -46,12 +142,7 @@ app.post('/compress', (req, res) => {
             const result = JSON.parse(jsonLine);
             console.log('Compressor CLI output:', output);
             console.log('Parsed JSON line:', jsonLine);
-            res.json({
-                ...result,
-                timestamp: new Date().toISOString(),
-                originalSize: text.length,
-                compressedSize: result.compressed.length
-            });
+            respond(result);
         } catch (e) {
             res.status(500).json({ error: 'Invalid output from compressor' });
         }
@@ -60,13 +151,13 @@ app.post('/compress', (req, res) => {
 
 // Decompression endpoint
 app.post('/decompress', (req, res) => {
-    const { compressed, primaryIndex } = req.body;
-    if (!compressed || primaryIndex === undefined) {
+    const { compressed, primaryIndex, blocks } = req.body;
+    if (!Array.isArray(blocks) && (!compressed || primaryIndex === undefined)) {
         return res.status(400).json({ error: 'Missing compressed data or primary index' });
     }
 
     const exeName = process.platform === 'win32' ? 'decompressor_cli.exe' : './decompressor_cli';
-    const decompressor = spawn(exeName, [], { cwd: __dirname });
+    const decompressor = spawn(exeName, [`--model-dir=${MODEL_DIR}`, ...DECOMPRESS_ARGS], { cwd: __dirname });
 
     let output = '';
     let error = '';
@@ -100,9 +191,14 @@ app.post('/upload', upload.single('file'), (req, res) => {
         return res.status(400).json({ error: 'File is empty' });
     }
 
+    const { coder } = req.body;
+    if (coder && !ENTROPY_CODERS.includes(coder)) {
+        return res.status(400).json({ error: `Unknown coder, expected one of: ${ENTROPY_CODERS.join(', ')}` });
+    }
+
     // Use the same compression logic
     const exeName = process.platform === 'win32' ? 'compressor_cli.exe' : './compressor_cli';
-    const compressor = spawn(exeName, [], { cwd: __dirname });
+    const compressor = spawn(exeName, coderArgs(coder), { cwd: __dirname });
 
     let output = '';
     let error = '';
@@ -113,7 +209,13 @@ app.post('/upload', upload.single('file'), (req, res) => {
     compressor.stdout.on('data', (data) => { output += data.toString(); });
     compressor.stderr.on('data', (data) => { error += data.toString(); });
 
+    // Stop compressing if the client goes away before we answer
+    res.on('close', () => {
+        if (!res.writableFinished) compressor.kill('SIGTERM');
+    });
+
     compressor.on('close', (code) => {
+        if (res.writableEnded || res.destroyed) return;
         if (code !== 0) {
             return res.status(500).json({ error: error || 'Compression failed' });
         }
@@ -134,6 +236,157 @@ app.post('/upload', upload.single('file'), (req, res) => {
     });
 });
 
+// Predicted ratio and compression time without compressing: multipart
+// `file` or JSON `{ text }`, optional `coder` and `model`
+app.post('/estimate', upload.single('file'), (req, res) => {
+    const text = req.file ? req.file.buffer.toString('utf8') : req.body.text;
+    if (!text) return res.status(400).json({ error: 'No text or file provided' });
+
+    const { coder, model } = req.body;
+    if (coder && !ENTROPY_CODERS.includes(coder)) {
+        return res.status(400).json({ error: `Unknown coder, expected one of: ${ENTROPY_CODERS.join(', ')}` });
+    }
+    if (model && !MODEL_ID_PATTERN.test(model)) {
+        return res.status(400).json({ error: 'Invalid model id' });
+    }
+
+    const exeName = process.platform === 'win32' ? 'compressor_cli.exe' : './compressor_cli';
+    const estimator = spawn(exeName, ['--estimate', ...coderArgs(coder), ...modelArgs(model)], { cwd: __dirname });
+
+    let output = '';
+    let error = '';
+
+    estimator.stdin.write(text);
+    estimator.stdin.end();
+
+    estimator.stdout.on('data', (data) => { output += data.toString(); });
+    estimator.stderr.on('data', (data) => { error += data.toString(); });
+
+    estimator.on('close', (code) => {
+        if (code !== 0) {
+            return res.status(500).json({ error: error || 'Estimation failed' });
+        }
+        try {
+            const lines = output.trim().split('\n');
+            res.json({ ...JSON.parse(lines[lines.length - 1]), timestamp: new Date().toISOString() });
+        } catch (e) {
+            res.status(500).json({ error: 'Invalid output from compressor' });
+        }
+    });
+});
+
+// Async compression jobs for large inputs. The CLI runs in block mode,
+// reports per-block progress on stderr and stops cleanly on SIGTERM.
+const JOB_TTL_MS = parseInt(process.env.MLC_JOB_TTL_MS || '600000', 10);
+const jobs = new Map();
+
+function jobView(job) {
+    return {
+        jobId: job.id,
+        status: job.status,
+        progress: job.progress,
+        filename: job.filename,
+        originalSize: job.originalSize,
+        createdAt: job.createdAt,
+        error: job.error
+    };
+}
+
+function finishJob(job, status, fields = {}) {
+    Object.assign(job, { status, child: null, finishedAt: new Date().toISOString() }, fields);
+    setTimeout(() => jobs.delete(job.id), JOB_TTL_MS).unref();
+}
+
+// Submit a job: multipart `file` or JSON `{ text }`, optional `coder`
+app.post('/jobs', upload.single('file'), (req, res) => {
+    const text = req.file ? req.file.buffer.toString('utf8') : req.body.text;
+    if (!text) return res.status(400).json({ error: 'No text or file provided' });
+
+    const { coder } = req.body;
+    if (coder && !ENTROPY_CODERS.includes(coder)) {
+        return res.status(400).json({ error: `Unknown coder, expected one of: ${ENTROPY_CODERS.join(', ')}` });
+    }
+
+    const exeName = process.platform === 'win32' ? 'compressor_cli.exe' : './compressor_cli';
+    const compressor = spawn(exeName, ['--blocks', ...coderArgs(coder)], { cwd: __dirname });
+
+    const job = {
+        id: crypto.randomUUID(),
+        status: 'running',
+        progress: { done: 0, total: 0 },
+        filename: req.file ? req.file.originalname : undefined,
+        originalSize: text.length,
+        createdAt: new Date().toISOString(),
+        child: compressor
+    };
+    jobs.set(job.id, job);
+
+    let output = '';
+    let error = '';
+    let pendingLine = '';
+
+    compressor.stdout.on('data', (data) => { output += data.toString(); });
+    compressor.stderr.on('data', (data) => {
+        const lines = (pendingLine + data.toString()).split('\n');
+        pendingLine = lines.pop();
+        for (const line of lines) {
+            const match = /^\[Progress\] (\d+)\/(\d+)/.exec(line);
+            if (match) job.progress = { done: Number(match[1]), total: Number(match[2]) };
+            else error += line + '\n';
+        }
+    });
+
+    compressor.on('close', (code) => {
+        if (job.status === 'cancelled') return finishJob(job, 'cancelled');
+        if (code !== 0) return finishJob(job, 'failed', { error: error || 'Compression failed' });
+        try {
+            const result = JSON.parse(output.trim());
+            finishJob(job, 'done', {
+                result: {
+                    ...result,
+                    timestamp: new Date().toISOString(),
+                    originalSize: job.originalSize,
+                    compressedSize: result.blocks.reduce((sum, b) => sum + b.compressed.length, 0),
+                    filename: job.filename
+                }
+            });
+        } catch (e) {
+            finishJob(job, 'failed', { error: 'Invalid output from compressor' });
+        }
+    });
+
+    compressor.stdin.write(text);
+    compressor.stdin.end();
+
+    res.status(202).json(jobView(job));
+});
+
+// Poll job status and progress
+app.get('/jobs/:id', (req, res) => {
+    const job = jobs.get(req.params.id);
+    if (!job) return res.status(404).json({ error: 'Unknown job' });
+    res.json(jobView(job));
+});
+
+// Fetch the compressed result of a finished job
+app.get('/jobs/:id/result', (req, res) => {
+    const job = jobs.get(req.params.id);
+    if (!job) return res.status(404).json({ error: 'Unknown job' });
+    if (job.status !== 'done') return res.status(409).json(jobView(job));
+    res.json(job.result);
+});
+
+// Cancel a running job
+app.delete('/jobs/:id', (req, res) => {
+    const job = jobs.get(req.params.id);
+    if (!job) return res.status(404).json({ error: 'Unknown job' });
+    if (job.status === 'running') {
+        job.status = 'cancelled';
+        job.child.kill('SIGTERM');
+    }
+    res.json(jobView(job));
+});
+
 app.listen(PORT, () => {
     console.log(`Server running on port ${PORT}`);
 }); 
\ No newline at end of file